@@ -0,0 +1,161 @@
+// Compares sonify::FFTPlan with the radix-2 transform it replaced, for
+// speed and for accuracy against a long double DFT.
+//
+//   cmake -DSONIFY_BUILD_BENCHMARKS=ON .. && ./sonify_fft_bench
+
+#include "FFT.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <numbers>
+#include <print>
+#include <random>
+
+using sonify::complex;
+using sonify::vec_complex;
+
+namespace
+{
+    // The original implementation, twiddles advanced by repeated rotation
+    void referenceFFT(vec_complex &a, bool invert = false) noexcept
+    {
+        const size_t N = a.size();
+
+        for (size_t i = 1, j = 0; i < N; i++)
+        {
+            size_t bit = N >> 1;
+            for (; j & bit; bit >>= 1)
+                j ^= bit;
+            j ^= bit;
+            if (i < j) std::swap(a[i], a[j]);
+        }
+
+        for (size_t len = 2; len <= N; len <<= 1)
+        {
+            double ang = 2 * std::numbers::pi / len * (invert ? 1 : -1);
+            complex wlen(std::cos(ang), std::sin(ang));
+            for (size_t i = 0; i < N; i += len)
+            {
+                complex w(1);
+                for (size_t j = 0; j < len / 2; j++)
+                {
+                    complex u          = a[i + j];
+                    complex v          = a[i + j + len / 2] * w;
+                    a[i + j]           = u + v;
+                    a[i + j + len / 2] = u - v;
+                    w *= wlen;
+                }
+            }
+        }
+
+        if (invert)
+            for (auto &x : a)
+                x /= static_cast<double>(N);
+    }
+
+    // Relative RMS error of `bins` against an exact DFT of `x`
+    double dftError(const std::vector<double> &x,
+                    std::span<const complex> bins) noexcept
+    {
+        const size_t N = x.size();
+        long double err = 0, ref = 0;
+        for (size_t k = 0; k < bins.size(); k++)
+        {
+            std::complex<long double> sum = 0;
+            for (size_t n = 0; n < N; n++)
+            {
+                const long double ang =
+                    -2.0L * std::numbers::pi_v<long double> *
+                    static_cast<long double>((k * n) % N) / N;
+                sum += static_cast<long double>(x[n]) *
+                       std::complex<long double>(std::cos(ang),
+                                                 std::sin(ang));
+            }
+            const std::complex<long double> d(bins[k].real() - sum.real(),
+                                              bins[k].imag() - sum.imag());
+            err += std::norm(d);
+            ref += std::norm(sum);
+        }
+        return std::sqrt(static_cast<double>(err / ref));
+    }
+
+    template <typename F>
+    double nsPerRun(size_t runs, F &&func) noexcept
+    {
+        const auto t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < runs; i++)
+            func();
+        const std::chrono::duration<double, std::nano> dt =
+            std::chrono::steady_clock::now() - t0;
+        return dt.count() / runs;
+    }
+} // namespace
+
+int
+main()
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+    std::println("backend: {}", sonify::FFTPlan::backend());
+
+    std::println("\naccuracy, relative RMS error against a long double DFT");
+    std::println("{:>8} {:>12} {:>12}", "size", "reference", "real plan");
+    for (size_t n : { 1024, 8192 })
+    {
+        std::vector<double> x(n);
+        for (double &v : x)
+            v = dist(rng);
+
+        vec_complex ref(x.begin(), x.end());
+        referenceFFT(ref);
+
+        vec_complex bins(n / 2 + 1);
+        sonify::FFTPlan::get(n).forwardReal(x, bins);
+
+        std::println("{:>8} {:>12.3e} {:>12.3e}", n,
+                     dftError(x, std::span(ref).first(n / 2 + 1)),
+                     dftError(x, bins));
+    }
+
+    std::println("\nspeed, ns per transform");
+    std::println("{:>8} {:>12} {:>12} {:>12} {:>12}", "size", "reference",
+                 "complex", "real", "speedup");
+    for (size_t n = 256; n <= (size_t(1) << 18); n <<= 2)
+    {
+        const sonify::FFTPlan &plan = sonify::FFTPlan::get(n);
+        const size_t runs           = std::max<size_t>(8, (size_t(1) << 24) / n);
+
+        std::vector<double> x(n);
+        for (double &v : x)
+            v = dist(rng);
+
+        vec_complex a(n), bins(n / 2 + 1);
+        std::vector<double> back(n);
+
+        const double tRef = nsPerRun(runs, [&]
+        {
+            a.assign(x.begin(), x.end());
+            referenceFFT(a);
+        });
+        const double tComplex = nsPerRun(runs, [&]
+        {
+            a.assign(x.begin(), x.end());
+            plan.forward(a);
+        });
+        const double tReal =
+            nsPerRun(runs, [&] { plan.forwardReal(x, bins); });
+
+        // round trip, to catch a broken inverse
+        plan.inverseReal(bins, back);
+        double err = 0;
+        for (size_t i = 0; i < n; i++)
+            err = std::max(err, std::fabs(back[i] - x[i]));
+
+        std::println("{:>8} {:>12.0f} {:>12.0f} {:>12.0f} {:>11.1f}x{}", n,
+                     tRef, tComplex, tReal, tRef / tReal,
+                     err > 1e-9 ? "  ROUND TRIP FAILED" : "");
+    }
+
+    return 0;
+}
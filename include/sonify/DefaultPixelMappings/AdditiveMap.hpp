@@ -0,0 +1,102 @@
+#pragma once
+
+#include "sonify/MapTemplate.hpp"
+#include "sonify/OscillatorBank.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// Every pixel of a column drives its own partial: the first pixel (the top of
+// a column) gets the maximum frequency and the last one the minimum, the
+// brightness sets the amplitude. A column is rendered by a vectorized
+// oscillator bank with one voice per audible pixel. With several channels
+// every partial is panned to the position of its own pixel.
+class AdditiveMap : public MapTemplate
+{
+public:
+
+    using MapTemplate::mapping;
+
+    bool positionDependent() const noexcept override { return false; }
+
+    size_t columnSamples(const PixelView &pixelCol) const noexcept override
+    {
+        return pixelCol.empty() ? 0 : MapTemplate::columnSamples(pixelCol);
+    }
+
+    std::vector<short> mapping(const PixelView &pixelCol) noexcept override
+    {
+        std::vector<short> fs(columnSamples(pixelCol));
+        mapInto(pixelCol, fs);
+        return fs;
+    }
+
+    void mapInto(const PixelView &pixelCol,
+                 std::span<short> out) noexcept override
+    {
+        mapInto(pixelCol, out, Panning{});
+    }
+
+    void mapInto(const PixelView &pixelCol, std::span<short> out,
+                 const Panning &pan) noexcept override
+    {
+        const size_t N = pixelCol.size();
+        const size_t C = std::max(1u, pan.channels);
+        std::fill(out.begin(), out.end(), 0);
+        if (N == 0 || out.empty()) return;
+
+        const double nyquist = _sample_rate / 2.0;
+        const double last    = static_cast<double>(std::max<size_t>(1, N - 1));
+
+        // Dark pixels and partials above Nyquist get no voice
+        OscillatorBank osc(_sample_rate, N);
+        osc.setChannels(static_cast<unsigned int>(C));
+        double power  = 0;
+        size_t voices = 0;
+        for (size_t i = 0; i < N; ++i)
+        {
+            const auto px = pixelCol[i];
+            const float amp =
+                std::max({ px.r(), px.g(), px.b() }) * px.a() / (255.0f * 255.0f);
+            if (amp < 1.0f / 255.0f) continue;
+
+            const double freq =
+                freq_map(0, last, _min_freq, _max_freq, last - i);
+            if (freq <= 0 || freq >= nyquist) continue;
+
+            osc.set(voices, freq, amp, false);
+            // spread the start phases, partials starting together would add
+            // up to a click
+            osc.setPhase(voices, std::fmod(i * 0.618033988749895, 1.0));
+            if (C > 1)
+                osc.setPan(voices, pan.gains(pan.position(px.x(), px.y())));
+            power += static_cast<double>(amp) * amp;
+            ++voices;
+        }
+
+        if (voices == 0) return;
+        osc.resize(voices);
+
+        std::vector<float> mix(out.size());
+        osc.render(std::span<float>(mix));
+
+        // RMS of the sum is sqrt(power / 2), aim for about -12 dB, with a
+        // short fade at both ends of the column. Panning keeps the power.
+        const size_t frames = out.size() / C;
+        const float gain    = static_cast<float>(0.35 / std::sqrt(power));
+        const size_t fade   = std::min<size_t>(frames / 2,
+                                               static_cast<size_t>(
+                                                   0.005f * _sample_rate));
+        for (size_t n = 0; n < frames * C; ++n)
+        {
+            const size_t f = n / C;
+            float env      = 1.0f;
+            if (f < fade) env = static_cast<float>(f) / fade;
+            else if (f >= frames - fade)
+                env = static_cast<float>(frames - 1 - f) / fade;
+
+            const float s = std::clamp(mix[n] * gain * env, -1.0f, 1.0f);
+            out[n]        = static_cast<short>(s * 32767.0f);
+        }
+    }
+};
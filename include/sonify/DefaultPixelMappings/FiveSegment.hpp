@@ -10,14 +10,31 @@ class FiveSegmentMap : public MapTemplate
 {
 public:
 
-    std::vector<short>
-    mapping(const std::vector<Pixel> &pixelCol) noexcept override
+    using MapTemplate::mapInto;
+    using MapTemplate::mapping;
+
+    bool positionDependent() const noexcept override { return false; }
+
+    size_t columnSamples(const PixelView &pixelCol) const noexcept override
+    {
+        if (pixelCol.empty()) return 0;
+        return static_cast<size_t>(_duration_per_sample * _sample_rate);
+    }
+
+    std::vector<short> mapping(const PixelView &pixelCol) noexcept override
     {
-        const size_t N =
-            static_cast<size_t>(_duration_per_sample * _sample_rate);
-        if (N == 0 || pixelCol.empty()) return {};
+        std::vector<short> fs(columnSamples(pixelCol));
+        mapInto(pixelCol, fs);
+        return fs;
+    }
 
-        std::vector<short> fs(N, 0);
+    void mapInto(const PixelView &pixelCol,
+                 std::span<short> fs) noexcept override
+    {
+        const size_t N = fs.size();
+        if (N == 0 || pixelCol.empty()) return;
+
+        std::fill(fs.begin(), fs.end(), 0);
 
         const int nSegments = 5;
         const int segmentHeight =
@@ -36,8 +53,7 @@ public:
                  j < segmentHeight && seg * segmentHeight + j < pixelCol.size();
                  ++j)
             {
-                const Pixel &pixel = pixelCol[seg * segmentHeight + j];
-                const RGBA rgba    = pixel.rgba;
+                const RGBA rgba = pixelCol[seg * segmentHeight + j].rgba();
                 double mapped =
                     freq_map(0, 1000, _min_freq, _max_freq,
                              (rgba.r + rgba.g + rgba.b + rgba.a) / 4);
@@ -70,6 +86,5 @@ public:
 
         // Normalize overall
         utils::normalizeWave(fs);
-        return fs;
     }
 };
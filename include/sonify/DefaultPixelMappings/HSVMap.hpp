@@ -1,25 +1,44 @@
 #pragma once
 
 #include "sonify/MapTemplate.hpp"
+#include "sonify/OscillatorBank.hpp"
 
 class HSVMap : public MapTemplate
 {
 public:
 
-    std::vector<short>
-    mapping(const std::vector<Pixel> &pixelCol) noexcept override
+    using MapTemplate::mapInto;
+    using MapTemplate::mapping;
+
+    std::vector<short> mapping(const PixelView &pixelCol) noexcept override
+    {
+        std::vector<short> fs(columnSamples(pixelCol));
+        mapInto(pixelCol, fs);
+        return fs;
+    }
+
+    void mapInto(const PixelView &pixelCol,
+                 std::span<short> out) noexcept override
     {
         int N    = static_cast<int>(pixelCol.size());
         double f = 0;
 
-        for (const auto &px : pixelCol)
+        for (const auto px : pixelCol)
         {
-            const HSV hsv = utils::RGBtoHSV(px.rgba);
+            const HSV hsv = utils::RGBtoHSV(px.rgba());
             f += freq_map(0, 360, _min_freq, _max_freq, hsv.h) /
                  static_cast<double>(N);
         }
 
-        return utils::generateWave(utils::WaveType::SINE, 0.5, f,
-                                   _duration_per_sample, _sample_rate);
+        // One bank per worker. The phase follows from where the column
+        // starts, so columns of the same hue join without a step; the map
+        // is position dependent and --memoize cannot share its columns.
+        static thread_local OscillatorBank osc;
+        osc.setSampleRate(_sample_rate);
+        osc.reset();
+        osc.set(0, f, 0.5f, false);
+        osc.setPhase(0,
+                     f * static_cast<double>(pixelCol.start()) / _sample_rate);
+        osc.render(out);
     }
 };
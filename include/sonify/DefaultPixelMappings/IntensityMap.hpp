@@ -1,30 +1,52 @@
 #pragma once
 
 #include "sonify/MapTemplate.hpp"
+#include "sonify/OscillatorBank.hpp"
 #include "sonify/utils.hpp"
 
 class IntensityMap : public MapTemplate
 {
 public:
 
-    std::vector<short>
-    mapping(const std::vector<Pixel> &pixelCol) noexcept override
+    using MapTemplate::mapInto;
+    using MapTemplate::mapping;
+
+    bool positionDependent() const noexcept override { return false; }
+
+    size_t columnSamples(const PixelView &pixelCol) const noexcept override
+    {
+        return pixelCol.empty() ? 0 : MapTemplate::columnSamples(pixelCol);
+    }
+
+    std::vector<short> mapping(const PixelView &pixelCol) noexcept override
+    {
+        std::vector<short> fs(columnSamples(pixelCol));
+        mapInto(pixelCol, fs);
+        return fs;
+    }
+
+    void mapInto(const PixelView &pixelCol,
+                 std::span<short> out) noexcept override
     {
         const size_t N = pixelCol.size();
         double freq    = 0;
 
-        if (N == 0) return {};
+        if (N == 0) return;
 
-        for (const auto &px : pixelCol)
+        for (const auto px : pixelCol)
         {
-            const HSV hsv = utils::RGBtoHSV(px.rgba);
+            const HSV hsv = utils::RGBtoHSV(px.rgba());
             freq += freq_map(0, 1, _min_freq, _max_freq, hsv.v);
         }
 
-        auto fs = utils::generateWave(utils::WaveType::SINE, 0.25, freq,
-                                      _duration_per_sample, _sample_rate);
-        utils::applyFadeInOut(fs);
-        utils::normalizeWave(fs);
-        return fs;
+        // One bank per worker. Every column fades in and out, so it starts
+        // at phase 0 and identical columns can share their samples.
+        static thread_local OscillatorBank osc;
+        osc.setSampleRate(_sample_rate);
+        osc.reset();
+        osc.set(0, freq, 0.25f, false);
+        osc.render(out);
+        utils::applyFadeInOut(out);
+        utils::normalizeWave(out);
     }
 };
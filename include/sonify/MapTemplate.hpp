@@ -2,8 +2,14 @@
 #pragma once
 
 #include "Pixel.hpp"
+#include "PixelView.hpp"
 #include "utils.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <span>
+#include <stdexcept>
 #include <vector>
 
 class MapTemplate
@@ -13,8 +19,94 @@ public:
     using FreqMapFunc = short (*)(double in_min, double in_max, double out_min,
                                   double out_max, double val);
 
-    virtual ~MapTemplate()                                         = default;
-    virtual std::vector<short> mapping(const std::vector<Pixel> &) = 0;
+    virtual ~MapTemplate() = default;
+
+    // A mapping overrides at least one of the two `mapping` overloads. The
+    // engine calls the PixelView one, which by default expands the view into
+    // a vector of Pixel and forwards it to the vector one, so older mappings
+    // keep working unchanged. With neither overridden the defaults would
+    // call each other forever, this throws instead.
+    virtual std::vector<short> mapping(const PixelView &view)
+    {
+        if (s_forwarding == this)
+            throw std::logic_error(
+                "MapTemplate: a mapping must override one of the mapping() "
+                "overloads");
+
+        return mapping(view.toPixels());
+    }
+
+    virtual std::vector<short> mapping(const std::vector<Pixel> &pixelCol)
+    {
+        std::vector<unsigned char> rgba;
+        std::vector<PixelCoord> coords;
+        rgba.reserve(pixelCol.size() * 4);
+        coords.reserve(pixelCol.size());
+
+        for (const auto &px : pixelCol)
+        {
+            rgba.insert(rgba.end(), { static_cast<unsigned char>(px.rgba.r),
+                                      static_cast<unsigned char>(px.rgba.g),
+                                      static_cast<unsigned char>(px.rgba.b),
+                                      static_cast<unsigned char>(px.rgba.a) });
+            coords.push_back({ px.x, px.y });
+        }
+
+        // set while the vector default forwards to the PixelView overload
+        struct Forwarding
+        {
+            const MapTemplate *previous;
+            explicit Forwarding(const MapTemplate *map) noexcept
+                : previous(s_forwarding)
+            {
+                s_forwarding = map;
+            }
+            ~Forwarding() noexcept { s_forwarding = previous; }
+        } forwarding(this);
+
+        return mapping(PixelView(rgba.data(), pixelCol.size(), coords.data()));
+    }
+
+    // Writes the samples of `view` into `out`, its slot of the timeline,
+    // which is exactly columnSamples(view) long. Mappings that can generate
+    // in place override this to skip the intermediate vector; by default the
+    // result of `mapping` is copied in, cut or padded with silence to fit.
+    // A mapping whose length varies has to say so through columnSamples.
+    virtual void mapInto(const PixelView &view, std::span<short> out)
+    {
+        const std::vector<short> samples = mapping(view);
+        const size_t n = std::min(out.size(), samples.size());
+
+        if (samples.size() != out.size() && !m_lengthWarned.exchange(true))
+            std::fprintf(stderr,
+                         "WARNING: MapTemplate: mapping returned %zu samples "
+                         "for a column of %zu, override columnSamples()\n",
+                         samples.size(), out.size());
+
+        std::copy_n(samples.begin(), n, out.begin());
+        std::fill(out.begin() + n, out.end(), 0);
+    }
+
+    // Writes columnSamples(view) interleaved frames of `pan.channels`
+    // channels into `out`. By default the mono output of mapInto is panned
+    // as a whole to the position of the middle pixel of the view; mappings
+    // with a sound per pixel override this to place every pixel on its own.
+    virtual void mapInto(const PixelView &view, std::span<short> out,
+                         const Panning &pan)
+    {
+        if (pan.channels <= 1)
+        {
+            mapInto(view, out);
+            return;
+        }
+
+        mapInto(view, out.first(out.size() / pan.channels));
+
+        const size_t mid = view.size() / 2;
+        utils::panInPlace(out, pan,
+                          view.empty() ? 0.5f
+                                       : pan.position(view.x(mid), view.y(mid)));
+    }
 
     inline float minFreq() const noexcept { return _min_freq; }
     inline float maxFreq() const noexcept { return _max_freq; }
@@ -25,6 +117,28 @@ public:
         return _duration_per_sample;
     }
 
+    // Number of samples `mapping` returns for `view`. The engine lays out the
+    // whole timeline from it before mapping any column, so it must be cheap
+    // and agree with `mapping`.
+    virtual size_t columnSamples(const PixelView &view) const noexcept
+    {
+        (void)view;
+        return static_cast<size_t>(static_cast<double>(_duration_per_sample) *
+                                   static_cast<int>(_sample_rate));
+    }
+
+    // Whether `mapping` may be called from several threads at once. Mappings
+    // that keep state between calls should override this and return false so
+    // that their columns are mapped one after another.
+    virtual bool threadSafe() const noexcept { return true; }
+
+    // Whether the output depends on the coordinates of the pixels or on the
+    // start of the column (PixelView::start) and not only on their colors.
+    // Mappings that only look at colors should return false so that identical
+    // columns anywhere in the image share their samples when memoization is
+    // on.
+    virtual bool positionDependent() const noexcept { return true; }
+
     inline void setMinFreq(float f) noexcept { _min_freq = f; }
     inline void setMaxFreq(float f) noexcept { _max_freq = f; }
     inline void setSampleRate(float f) noexcept { _sample_rate = f; }
@@ -34,6 +148,11 @@ public:
         _duration_per_sample = d;
     }
 
+private:
+
+    static inline thread_local const MapTemplate *s_forwarding{ nullptr };
+    std::atomic<bool> m_lengthWarned{ false }; // once per map, see mapInto
+
 protected:
 
     FreqMapFunc freq_map{ utils::LinearMap };
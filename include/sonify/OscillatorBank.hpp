@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Panning.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// A set of sine oscillators driven by 32 bit phase accumulators. The phase of
+// every voice carries over from one render() to the next, so consecutive
+// blocks join without a discontinuity, and frequency and amplitude changes
+// are ramped linearly over the block that follows them. The sine itself is a
+// branchless polynomial the compiler vectorizes, accurate to about 4e-6.
+class OscillatorBank
+{
+public:
+
+    explicit OscillatorBank(float sampleRate = 44100.0f,
+                            size_t voices    = 1) noexcept;
+
+    void resize(size_t voices) noexcept;
+    inline size_t size() const noexcept { return m_voices.size(); }
+
+    void setSampleRate(float sampleRate) noexcept;
+    inline float sampleRate() const noexcept { return m_sampleRate; }
+
+    // Target frequency (Hz) and amplitude of `voice`, reached at the end of
+    // the next render(). Without `glide` (and for a voice that was never
+    // rendered) the change applies from the first sample instead.
+    void set(size_t voice, double freq, float amp, bool glide = true) noexcept;
+
+    // Phase of `voice` in turns, [0, 1)
+    void setPhase(size_t voice, double turns) noexcept;
+
+    // Every voice back to phase 0 and silence
+    void reset() noexcept;
+
+    // Interleaved output channels of render(), 1 by default. Every voice
+    // plays on the two channels given to setPan(), the first one until then.
+    void setChannels(unsigned int channels) noexcept;
+    inline unsigned int channels() const noexcept { return m_channels; }
+    void setPan(size_t voice, const Panning::Gains &gains) noexcept;
+
+    // Writes the sum of the voices into `out`, out.size() / channels() frames
+    void render(std::span<float> out) noexcept;
+
+    // Same, scaled to the 16 bit range (1.0 = 32767) and clipped
+    void render(std::span<short> out) noexcept;
+
+private:
+
+    struct Voice
+    {
+        uint32_t phase{ 0 }, inc{ 0 }, target{ 0 };
+        float amp{ 0 }, targetAmp{ 0 };
+        bool started{ false };
+        Panning::Gains pan;
+    };
+
+    uint32_t increment(double freq) const noexcept;
+
+    std::vector<Voice> m_voices;
+    std::vector<float> m_mix; // of the 16 bit render()
+    float m_sampleRate;
+    unsigned int m_channels{ 1 };
+};
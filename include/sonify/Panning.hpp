@@ -0,0 +1,54 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+// Where the pixels of an image sit between the output channels. The channels
+// are spread evenly from left to right across the image, or, for the polar
+// traversals, around its center, a pixel being placed by its angle (the
+// first channel straight up, going clockwise).
+struct Panning
+{
+    unsigned int channels{ 1 };
+    int width{ 1 }, height{ 1 };
+    bool polar{ false };
+
+    // Two adjacent channels and their equal power gains
+    struct Gains
+    {
+        unsigned int first{ 0 }, second{ 0 };
+        float g0{ 1.0f }, g1{ 0.0f };
+    };
+
+    // Of pixel (x, y) in [0, 1]: 0 is the first channel, 1 the last one or,
+    // when polar, the first one again
+    inline float position(int x, int y) const noexcept
+    {
+        if (!polar)
+            return width > 1 ? static_cast<float>(x) / (width - 1) : 0.5f;
+
+        const double angle = std::atan2(x - (width - 1) / 2.0,
+                                        (height - 1) / 2.0 - y); // 0 is up
+        const double turns = angle / (2.0 * std::numbers::pi);
+        return static_cast<float>(turns < 0.0 ? turns + 1.0 : turns);
+    }
+
+    inline Gains gains(float position) const noexcept
+    {
+        Gains g;
+        if (channels <= 1) return g;
+
+        // polar: the channels are a ring, the last one next to the first
+        const unsigned int spans = polar ? channels : channels - 1;
+        const float p = std::fmin(std::fmax(position, 0.0f), 1.0f) * spans;
+        const unsigned int c = std::min(static_cast<unsigned int>(p), spans - 1);
+        const float frac = p - static_cast<float>(c);
+
+        g.first  = c;
+        g.second = (c + 1) % channels;
+        g.g0     = std::cos(frac * static_cast<float>(std::numbers::pi / 2));
+        g.g1     = std::sin(frac * static_cast<float>(std::numbers::pi / 2));
+        return g;
+    }
+};
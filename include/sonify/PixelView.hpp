@@ -0,0 +1,163 @@
+#pragma once
+
+#include "Pixel.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+typedef struct
+{
+    int x, y;
+} PixelCoord;
+
+// Lightweight read-only view over a column of RGBA8 pixels (4 bytes each, in
+// r, g, b, a order like raylib's Color). The pixels are `stride` pixels apart
+// in memory, so a column of a row-major image is viewed in place without any
+// copy. Coordinates are only computed when asked for: either from an explicit
+// array, or from an origin and a step (x0 + (int)(i * dx), y0 + (int)(i * dy)).
+class PixelView
+{
+public:
+
+    // Single pixel of the view
+    class Ref
+    {
+    public:
+
+        Ref(const PixelView *view, size_t index) noexcept
+            : m_view(view), m_index(index), m_p(view->data(index))
+        {
+        }
+
+        inline unsigned char r() const noexcept { return m_p[0]; }
+        inline unsigned char g() const noexcept { return m_p[1]; }
+        inline unsigned char b() const noexcept { return m_p[2]; }
+        inline unsigned char a() const noexcept { return m_p[3]; }
+        inline RGBA rgba() const noexcept
+        {
+            return RGBA{ m_p[0], m_p[1], m_p[2], m_p[3] };
+        }
+        inline int x() const noexcept { return m_view->x(m_index); }
+        inline int y() const noexcept { return m_view->y(m_index); }
+        inline Pixel pixel() const noexcept { return Pixel{ rgba(), x(), y() }; }
+
+    private:
+
+        const PixelView *m_view;
+        size_t m_index;
+        const unsigned char *m_p;
+    };
+
+    class Iterator
+    {
+    public:
+
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = Ref;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = Ref;
+
+        Iterator(const PixelView *view, size_t index) noexcept
+            : m_view(view), m_index(index)
+        {
+        }
+
+        inline Ref operator*() const noexcept { return Ref(m_view, m_index); }
+        inline Iterator &operator++() noexcept
+        {
+            ++m_index;
+            return *this;
+        }
+        inline Iterator operator++(int) noexcept
+        {
+            Iterator tmp = *this;
+            ++m_index;
+            return tmp;
+        }
+        inline bool operator==(const Iterator &other) const noexcept
+        {
+            return m_index == other.m_index;
+        }
+        inline bool operator!=(const Iterator &other) const noexcept
+        {
+            return m_index != other.m_index;
+        }
+
+    private:
+
+        const PixelView *m_view;
+        size_t m_index;
+    };
+
+    PixelView() = default;
+
+    // `data` is the first pixel, the next ones are `stride` pixels apart
+    PixelView(const unsigned char *data, size_t count, std::ptrdiff_t stride,
+              int x0, int y0, float dx, float dy) noexcept
+        : m_data(data), m_count(count), m_stride(stride), m_x0(x0), m_y0(y0),
+          m_dx(dx), m_dy(dy)
+    {
+    }
+
+    // Packed pixels with one explicit coordinate per pixel
+    PixelView(const unsigned char *data, size_t count,
+              const PixelCoord *coords) noexcept
+        : m_data(data), m_count(count), m_stride(1), m_coords(coords)
+    {
+    }
+
+    inline size_t size() const noexcept { return m_count; }
+    inline bool empty() const noexcept { return m_count == 0; }
+    inline std::ptrdiff_t stride() const noexcept { return m_stride; }
+
+    // Pointer to the RGBA8 bytes of pixel `i`
+    inline const unsigned char *data(size_t i = 0) const noexcept
+    {
+        return m_data + static_cast<std::ptrdiff_t>(i) * m_stride * 4;
+    }
+
+    inline int x(size_t i) const noexcept
+    {
+        if (m_coords) return m_coords[i].x;
+        return m_x0 + static_cast<int>(static_cast<float>(i) * m_dx);
+    }
+
+    inline int y(size_t i) const noexcept
+    {
+        if (m_coords) return m_coords[i].y;
+        return m_y0 + static_cast<int>(static_cast<float>(i) * m_dy);
+    }
+
+    // First frame of the column in the timeline, set by the engine before
+    // mapping, so a mapping can carry its waveform over from the previous
+    // column. Zero outside of a render.
+    inline uint64_t start() const noexcept { return m_start; }
+    inline void setStart(uint64_t frame) noexcept { m_start = frame; }
+
+    inline Ref operator[](size_t i) const noexcept { return Ref(this, i); }
+    inline Iterator begin() const noexcept { return Iterator(this, 0); }
+    inline Iterator end() const noexcept { return Iterator(this, m_count); }
+
+    // Expands the view into the old `Pixel` representation
+    std::vector<Pixel> toPixels() const noexcept
+    {
+        std::vector<Pixel> pixels;
+        pixels.reserve(m_count);
+        for (size_t i = 0; i < m_count; ++i)
+            pixels.push_back((*this)[i].pixel());
+        return pixels;
+    }
+
+private:
+
+    const unsigned char *m_data{ nullptr };
+    size_t m_count{ 0 };
+    std::ptrdiff_t m_stride{ 1 };
+    int m_x0{ 0 }, m_y0{ 0 };
+    float m_dx{ 0.0f }, m_dy{ 0.0f };
+    const PixelCoord *m_coords{ nullptr };
+    uint64_t m_start{ 0 };
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "utils.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Band-limited single cycles of a utils::WaveType, summed from their Fourier
+// series once, with one table per octave of harmonics ("mip-mapped"): level k
+// holds the first 1024 >> k harmonics. An oscillator reads the richest level
+// whose harmonics all stay below Nyquist at its frequency, so nothing aliases.
+class Wavetable
+{
+public:
+
+    static constexpr int SIZE_BITS = 12;
+    static constexpr uint32_t SIZE = 1u << SIZE_BITS; // samples per cycle
+    static constexpr int LEVELS    = 11;
+
+    // Shared tables of `type`, built on first use
+    static const Wavetable &get(utils::WaveType type) noexcept;
+
+    // Builds the tables of every type now instead of on first use
+    static void prepare() noexcept;
+
+    // Level for a frequency of `cycles` cycles per sample, nullptr when even
+    // the fundamental is above Nyquist. SIZE + 1 samples, the last one
+    // repeating the first for interpolation.
+    const float *level(double cycles) const noexcept;
+
+    // Linearly interpolated sample of `table` at `phase` (2^32 = one cycle)
+    static inline float lookup(const float *table, uint32_t phase) noexcept
+    {
+        constexpr int FRAC_BITS = 32 - SIZE_BITS;
+        constexpr float SCALE   = 1.0f / (1u << FRAC_BITS);
+
+        const uint32_t i = phase >> FRAC_BITS;
+        const float frac =
+            static_cast<float>(phase & ((1u << FRAC_BITS) - 1)) * SCALE;
+        return table[i] + (table[i + 1] - table[i]) * frac;
+    }
+
+private:
+
+    explicit Wavetable(utils::WaveType type) noexcept;
+
+    std::vector<float> m_tables; // LEVELS tables of SIZE + 1 samples
+};
+
+// One voice reading a Wavetable through a 32 bit phase accumulator. The phase
+// carries over from one render() to the next.
+class WavetableOscillator
+{
+public:
+
+    WavetableOscillator(utils::WaveType type, float sampleRate) noexcept;
+
+    // Takes effect from the next render(), without resetting the phase
+    void set(double freq, float amp) noexcept;
+
+    inline void reset() noexcept { m_phase = 0; }
+
+    void render(std::span<float> out) noexcept;
+
+    // Same, scaled to the 16 bit range (1.0 = 32767) and clipped
+    void render(std::span<short> out) noexcept;
+
+private:
+
+    const Wavetable &m_wave;
+    const float *m_table{ nullptr };
+    float m_sampleRate, m_amp{ 0 };
+    uint32_t m_phase{ 0 }, m_inc{ 0 };
+    std::vector<float> m_mix; // of the 16 bit render()
+};
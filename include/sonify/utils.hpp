@@ -1,8 +1,10 @@
 #pragma once
 
+#include "Panning.hpp"
 #include "Pixel.hpp"
 
 #include <cmath>
+#include <span>
 #include <vector>
 
 namespace utils
@@ -27,6 +29,8 @@ namespace utils
 
     // ------- Signal generation -------
 
+    // Naive shapes at time `t`, they alias at high frequencies. generateWave
+    // uses band-limited wavetables (see Wavetable.hpp) instead.
     static inline double sineAt(double t, double freq)
     {
         return sin(2.0 * M_PI * freq * t);
@@ -34,7 +38,8 @@ namespace utils
 
     static inline double squareAt(double t, double freq)
     {
-        return (sineAt(t, freq) >= 0.0) ? 1.0 : -1.0;
+        double frac = freq * t - floor(freq * t); // [0,1)
+        return (frac < 0.5) ? 1.0 : -1.0;
     }
 
     static inline double sawtoothAt(double t, double freq)
@@ -53,13 +58,24 @@ namespace utils
                                     double frequency, double time,
                                     int samplerate) noexcept;
 
+    // Same as above, filling all of `out` instead of `time` seconds
+    void generateWave(WaveType type, double amplitude, double frequency,
+                      int samplerate, std::span<short> out) noexcept;
+
     // ------- Signal Effects --------
     void applyEnvelope(std::vector<short> &samples) noexcept;
     void normalizeWave(std::vector<short> &wave) noexcept;
+    void normalizeWave(std::span<short> wave) noexcept;
     void applyFadeInOut(std::vector<short> &wave,
                         double fadeFrac = 0.05) noexcept;
+    void applyFadeInOut(std::span<short> wave, double fadeFrac = 0.05) noexcept;
     std::vector<short> panStereo(const std::vector<short> &mono,
                                  float pan) noexcept;
+    // `buffer` holds buffer.size() / pan.channels frames whose mono samples
+    // are at its start; spreads them in place into interleaved frames, each
+    // sample going to the two channels around `position` (Panning::position)
+    void panInPlace(std::span<short> buffer, const Panning &pan,
+                    float position) noexcept;
     // Quantize arbitrary frequency to nearest note in 12-TET scale
     double quantizeToNote(double freq) noexcept;
 
@@ -0,0 +1,182 @@
+#include "AudioTimeline.hpp"
+
+#include "raylib.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+AudioTimeline::~AudioTimeline() noexcept
+{
+    clear();
+}
+
+void
+AudioTimeline::clear() noexcept
+{
+    for (auto &c : m_chunks)
+        if (c.mapped) munmap(c.data, c.mapped);
+
+    m_chunks.clear();
+    m_size = 0;
+
+    if (m_fd >= 0) ::close(m_fd);
+    m_fd = -1;
+}
+
+void
+AudioTimeline::swap(AudioTimeline &other) noexcept
+{
+    std::swap(m_chunks, other.m_chunks);
+    std::swap(m_size, other.m_size);
+    std::swap(m_fd, other.m_fd);
+}
+
+bool
+AudioTimeline::allocate(uint64_t samples,
+                        std::span<const size_t> cuts) noexcept
+{
+    clear();
+
+    // Chunks end every CHUNK samples, moved back to the last cut before that
+    // point when there are cuts. A range longer than CHUNK gets a chunk of
+    // its own.
+    std::vector<Chunk> chunks;
+    uint64_t begin = 0;
+    while (begin < samples)
+    {
+        uint64_t end = std::min<uint64_t>(begin + CHUNK, samples);
+        if (!cuts.empty())
+        {
+            auto it = std::upper_bound(cuts.begin(), cuts.end(), end);
+            if (it != cuts.begin() && *(it - 1) > begin) end = *(it - 1);
+            else if (it != cuts.end()) end = std::min<uint64_t>(*it, samples);
+        }
+
+        Chunk c;
+        c.begin = begin;
+        c.size  = static_cast<size_t>(end - begin);
+        chunks.push_back(std::move(c));
+        begin = end;
+    }
+
+    if (!m_backingDir.empty())
+    {
+        if (!map(chunks)) return false;
+    }
+    else
+    {
+        for (auto &c : chunks)
+        {
+            c.heap = std::make_unique<short[]>(c.size); // zeroed
+            c.data = c.heap.get();
+        }
+    }
+
+    m_chunks = std::move(chunks);
+    m_size   = samples;
+    return true;
+}
+
+bool
+AudioTimeline::map(std::vector<Chunk> &chunks) noexcept
+{
+    std::string path = m_backingDir + "/sonify-timeline-XXXXXX";
+    m_fd             = mkstemp(path.data());
+    if (m_fd < 0)
+    {
+        TraceLog(LOG_ERROR, "Unable to create a timeline file in %s",
+                 m_backingDir.c_str());
+        return false;
+    }
+    // gone with the descriptor, even after a crash
+    unlink(path.c_str());
+
+    // every mapping starts on a page
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    std::vector<off_t> offsets;
+    off_t total = 0;
+    for (auto &c : chunks)
+    {
+        offsets.push_back(total);
+        c.mapped = (c.size * sizeof(short) + page - 1) / page * page;
+        total += static_cast<off_t>(c.mapped);
+    }
+
+    // a sparse file reads back as silence
+    if (ftruncate(m_fd, total) != 0)
+    {
+        TraceLog(LOG_ERROR, "Unable to size the timeline file");
+        clear();
+        return false;
+    }
+
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        void *p = mmap(nullptr, chunks[i].mapped, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, m_fd, offsets[i]);
+        if (p == MAP_FAILED)
+        {
+            TraceLog(LOG_ERROR, "Unable to map the timeline file");
+            for (size_t j = 0; j < i; ++j)
+                munmap(chunks[j].data, chunks[j].mapped);
+            clear();
+            return false;
+        }
+        // written once, then read front to back
+        madvise(p, chunks[i].mapped, MADV_SEQUENTIAL);
+        chunks[i].data = static_cast<short *>(p);
+    }
+
+    return true;
+}
+
+size_t
+AudioTimeline::find(uint64_t pos) const noexcept
+{
+    auto it = std::upper_bound(m_chunks.begin(), m_chunks.end(), pos,
+                               [](uint64_t p, const Chunk &c)
+    { return p < c.begin; });
+    return static_cast<size_t>(std::distance(m_chunks.begin(), it)) - 1;
+}
+
+short
+AudioTimeline::operator[](uint64_t pos) const noexcept
+{
+    if (pos >= m_size) return 0;
+    const Chunk &c = m_chunks[find(pos)];
+    return c.data[pos - c.begin];
+}
+
+size_t
+AudioTimeline::read(uint64_t pos, std::span<short> out) const noexcept
+{
+    if (pos >= m_size) return 0;
+
+    const size_t n = static_cast<size_t>(
+        std::min<uint64_t>(out.size(), m_size - pos));
+    size_t done    = 0;
+
+    for (size_t i = find(pos); done < n; ++i)
+    {
+        const Chunk &c   = m_chunks[i];
+        const size_t at  = static_cast<size_t>(pos + done - c.begin);
+        const size_t run = std::min(n - done, c.size - at);
+        std::memcpy(out.data() + done, c.data + at, run * sizeof(short));
+        done += run;
+    }
+
+    return n;
+}
+
+std::span<short>
+AudioTimeline::range(uint64_t begin, uint64_t end) noexcept
+{
+    if (begin >= end || begin >= m_size) return {};
+
+    Chunk &c = m_chunks[find(begin)];
+    return { c.data + (begin - c.begin), static_cast<size_t>(end - begin) };
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+// Samples of a whole sonification, stored in chunks of a few MiB instead of
+// one contiguous buffer, so multi-hour renders need no huge allocation and
+// positions are 64 bit. The chunks live on the heap or, with a backing
+// directory, in a memory mapped temporary file the kernel can page out
+// without touching swap.
+class AudioTimeline
+{
+public:
+
+    // Nominal samples per chunk
+    static constexpr size_t CHUNK = size_t(1) << 21;
+
+    AudioTimeline() = default;
+    ~AudioTimeline() noexcept;
+
+    AudioTimeline(const AudioTimeline &)            = delete;
+    AudioTimeline &operator=(const AudioTimeline &) = delete;
+
+    // Directory of the file backing the next allocate(), empty for the heap
+    inline void setBackingDir(const std::string &dir) noexcept
+    {
+        m_backingDir = dir;
+    }
+
+    // `samples` samples of silence. With `cuts` (sorted positions, e.g. the
+    // offsets of the columns of a plan), chunks only start at a cut, so that
+    // every range between two cuts is contiguous.
+    bool allocate(uint64_t samples,
+                  std::span<const size_t> cuts = {}) noexcept;
+
+    void clear() noexcept;
+
+    // Exchanges the samples (and their backing files) with `other`
+    void swap(AudioTimeline &other) noexcept;
+
+    inline uint64_t size() const noexcept { return m_size; }
+    inline bool empty() const noexcept { return m_size == 0; }
+
+    short operator[](uint64_t pos) const noexcept;
+
+    // Copies the samples from `pos` on into `out`, returns how many
+    size_t read(uint64_t pos, std::span<short> out) const noexcept;
+
+    // Samples [begin, end), which must not cross a chunk, see allocate()
+    std::span<short> range(uint64_t begin, uint64_t end) noexcept;
+
+    inline size_t chunks() const noexcept { return m_chunks.size(); }
+    inline std::span<const short> chunk(size_t i) const noexcept
+    {
+        return { m_chunks[i].data, m_chunks[i].size };
+    }
+
+private:
+
+    struct Chunk
+    {
+        short *data{ nullptr };
+        uint64_t begin{ 0 };
+        size_t size{ 0 };
+        size_t mapped{ 0 }; // bytes of the mapping, 0 on the heap
+        std::unique_ptr<short[]> heap;
+    };
+
+    // Chunk containing `pos`, which must be < size()
+    size_t find(uint64_t pos) const noexcept;
+
+    bool map(std::vector<Chunk> &chunks) noexcept;
+
+    std::vector<Chunk> m_chunks;
+    uint64_t m_size{ 0 };
+    std::string m_backingDir;
+    int m_fd{ -1 };
+};
@@ -0,0 +1,206 @@
+#include "BandReader.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdlib>
+
+namespace
+{
+    inline unsigned char scale(unsigned int v, int maxval) noexcept
+    {
+        if (maxval == 255) return static_cast<unsigned char>(v);
+        return static_cast<unsigned char>(std::min<unsigned int>(v, maxval) *
+                                          255u / maxval);
+    }
+} // namespace
+
+BandReader::~BandReader() noexcept
+{
+    close();
+}
+
+bool
+BandReader::supported(const std::string &path) noexcept
+{
+    std::FILE *f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    char magic[2] = { 0, 0 };
+    const bool ok = std::fread(magic, 1, 2, f) == 2 && magic[0] == 'P' &&
+                    (magic[1] == '5' || magic[1] == '6' || magic[1] == '7');
+    std::fclose(f);
+    return ok;
+}
+
+bool
+BandReader::open(const std::string &path) noexcept
+{
+    close();
+
+    m_file = std::fopen(path.c_str(), "rb");
+    if (!m_file)
+    {
+        TraceLog(LOG_ERROR, "Unable to open %s", path.c_str());
+        return false;
+    }
+
+    if (!readHeader())
+    {
+        TraceLog(LOG_ERROR, "%s is not a supported binary PNM/PAM image",
+                 path.c_str());
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void
+BandReader::close() noexcept
+{
+    if (m_file) std::fclose(m_file);
+    m_file = nullptr;
+    m_raw.clear();
+    m_raw.shrink_to_fit();
+}
+
+// Next whitespace separated token, skipping # comments
+bool
+BandReader::readToken(std::string &token) noexcept
+{
+    token.clear();
+    int c;
+
+    while ((c = std::fgetc(m_file)) != EOF)
+    {
+        if (c == '#')
+        {
+            while ((c = std::fgetc(m_file)) != EOF && c != '\n')
+                ;
+            continue;
+        }
+        if (!std::isspace(c)) break;
+    }
+
+    while (c != EOF && !std::isspace(c))
+    {
+        token.push_back(static_cast<char>(c));
+        c = std::fgetc(m_file);
+    }
+
+    // `c` is the single whitespace ending the token, the raster of P5/P6
+    // starts right after the one following the max value
+    return !token.empty();
+}
+
+bool
+BandReader::readHeader() noexcept
+{
+    std::string token;
+    if (!readToken(token)) return false;
+
+    long long w = 0, h = 0, maxval = 0, depth = 0;
+
+    if (token == "P5" || token == "P6")
+    {
+        depth = token == "P5" ? 1 : 3;
+
+        if (!readToken(token)) return false;
+        w = std::atoll(token.c_str());
+        if (!readToken(token)) return false;
+        h = std::atoll(token.c_str());
+        if (!readToken(token)) return false;
+        maxval = std::atoll(token.c_str());
+    }
+    else if (token == "P7")
+    {
+        while (readToken(token) && token != "ENDHDR")
+        {
+            if (token == "TUPLTYPE")
+            {
+                // implied by DEPTH, skip the rest of the line
+                int c;
+                while ((c = std::fgetc(m_file)) != EOF && c != '\n')
+                    ;
+                continue;
+            }
+
+            std::string value;
+            if (!readToken(value)) return false;
+
+            if (token == "WIDTH") w = std::atoll(value.c_str());
+            else if (token == "HEIGHT") h = std::atoll(value.c_str());
+            else if (token == "DEPTH") depth = std::atoll(value.c_str());
+            else if (token == "MAXVAL") maxval = std::atoll(value.c_str());
+        }
+        if (token != "ENDHDR") return false;
+    }
+    else { return false; }
+
+    // Each dimension has to fit pixel coordinates (int), their product does
+    // not: all offsets are 64-bit
+    if (w <= 0 || h <= 0 || w > INT_MAX || h > INT_MAX) return false;
+    if (depth < 1 || depth > 4 || maxval < 1 || maxval > 65535) return false;
+
+    m_width     = static_cast<int>(w);
+    m_height    = static_cast<int>(h);
+    m_channels  = static_cast<int>(depth);
+    m_maxval    = static_cast<int>(maxval);
+    m_dataStart = static_cast<int64_t>(ftello(m_file));
+
+    return m_dataStart > 0;
+}
+
+bool
+BandReader::read(int64_t row, int rows, Color *out) noexcept
+{
+    if (!m_file || row < 0 || rows <= 0 || row + rows > m_height)
+        return false;
+
+    const int bytes       = m_maxval > 255 ? 2 : 1;
+    const size_t rowBytes = static_cast<size_t>(m_width) * m_channels * bytes;
+    const size_t count    = static_cast<size_t>(m_width) * rows;
+
+    m_raw.resize(rowBytes * rows);
+
+    const int64_t at = m_dataStart + row * static_cast<int64_t>(rowBytes);
+    if (fseeko(m_file, static_cast<off_t>(at), SEEK_SET) != 0) return false;
+    if (std::fread(m_raw.data(), 1, m_raw.size(), m_file) != m_raw.size())
+        return false;
+
+    const unsigned char *p = m_raw.data();
+    unsigned int v[4]      = { 0, 0, 0, 0 };
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        // samples are big endian when 16-bit
+        for (int c = 0; c < m_channels; ++c)
+        {
+            v[c] = bytes == 2 ? (p[0] << 8) | p[1] : p[0];
+            p += bytes;
+        }
+
+        switch (m_channels)
+        {
+            case 1:
+            case 2:
+            {
+                const unsigned char g = scale(v[0], m_maxval);
+                out[i] = { g, g, g,
+                           m_channels == 2 ? scale(v[1], m_maxval)
+                                           : (unsigned char)255 };
+                break;
+            }
+
+            default:
+                out[i] = { scale(v[0], m_maxval), scale(v[1], m_maxval),
+                           scale(v[2], m_maxval),
+                           m_channels == 4 ? scale(v[3], m_maxval)
+                                           : (unsigned char)255 };
+                break;
+        }
+    }
+
+    return true;
+}
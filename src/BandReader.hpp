@@ -0,0 +1,49 @@
+#pragma once
+
+#include "raylib.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Reads binary Netpbm images (P5 grayscale, P6 RGB and P7 PAM with up to four
+// channels, 8 or 16 bits) a band of rows at a time, converting them to RGBA8.
+// Only the rows asked for are ever in memory, so images much larger than RAM
+// can be sonified row by row.
+class BandReader
+{
+public:
+
+    BandReader() = default;
+    ~BandReader() noexcept;
+
+    BandReader(const BandReader &)            = delete;
+    BandReader &operator=(const BandReader &) = delete;
+
+    // Whether `path` starts like an image this reader understands
+    static bool supported(const std::string &path) noexcept;
+
+    bool open(const std::string &path) noexcept;
+    void close() noexcept;
+
+    inline bool isOpen() const noexcept { return m_file != nullptr; }
+    inline int width() const noexcept { return m_width; }
+    inline int height() const noexcept { return m_height; }
+
+    // Decodes `rows` rows starting at `row` into `out`, which must hold
+    // rows * width() pixels
+    bool read(int64_t row, int rows, Color *out) noexcept;
+
+private:
+
+    bool readHeader() noexcept;
+    bool readToken(std::string &token) noexcept;
+
+    std::FILE *m_file{ nullptr };
+    int m_width{ 0 }, m_height{ 0 };
+    int m_channels{ 0 };    // 1 gray, 2 gray + alpha, 3 RGB, 4 RGBA
+    int m_maxval{ 255 };    // 16-bit samples above 255
+    int64_t m_dataStart{ 0 };
+    std::vector<unsigned char> m_raw; // one band as stored in the file
+};
@@ -0,0 +1,223 @@
+#include "BatchRunner.hpp"
+
+#include "WavWriter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <glob.h>
+#include <thread>
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    using Clock = std::chrono::steady_clock;
+
+    inline double msSince(Clock::time_point start) noexcept
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start)
+            .count();
+    }
+
+    bool isImage(const fs::path &path) noexcept
+    {
+        static const char *exts[] = { ".png", ".jpg", ".jpeg", ".bmp",
+                                      ".tga", ".gif", ".qoi", ".psd",
+                                      ".hdr", ".pic", ".ppm", ".pgm" };
+
+        std::string ext = path.extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+        return std::any_of(std::begin(exts), std::end(exts),
+                           [&ext](const char *e) { return ext == e; });
+    }
+
+    void replaceAll(std::string &str, const std::string &from,
+                    const std::string &to) noexcept
+    {
+        for (size_t pos = str.find(from); pos != std::string::npos;
+             pos        = str.find(from, pos + to.size()))
+            str.replace(pos, from.size(), to);
+    }
+
+    // Image decoded ahead of being mapped
+    struct Decoded
+    {
+        PixelStore pixels;
+        double ms{ 0 };
+        bool ok{ false };
+    };
+
+    void decode(const std::string &path, Decoded &out) noexcept
+    {
+        const auto start = Clock::now();
+
+        out.pixels.clear();
+        Image image = LoadImage(path.c_str());
+        out.ok      = IsImageValid(image) && out.pixels.load(image);
+        if (IsImageValid(image)) UnloadImage(image);
+
+        out.ms = msSince(start);
+    }
+} // namespace
+
+BatchRunner::BatchRunner(const Options &options) noexcept : m_options(options)
+{
+}
+
+std::vector<std::string>
+BatchRunner::collectInputs(const std::string &spec) noexcept
+{
+    std::vector<std::string> inputs;
+    std::error_code ec;
+
+    if (spec.find_first_of("*?[") != std::string::npos)
+    {
+        glob_t g;
+        if (glob(spec.c_str(), 0, nullptr, &g) == 0)
+        {
+            for (size_t i = 0; i < g.gl_pathc; ++i)
+                if (fs::is_regular_file(g.gl_pathv[i], ec))
+                    inputs.emplace_back(g.gl_pathv[i]);
+        }
+        globfree(&g);
+    }
+    else if (fs::is_directory(spec, ec))
+    {
+        for (const auto &entry : fs::directory_iterator(spec, ec))
+            if (entry.is_regular_file(ec) && isImage(entry.path()))
+                inputs.push_back(entry.path().string());
+
+        std::sort(inputs.begin(), inputs.end());
+    }
+    else if (fs::is_regular_file(spec, ec) && isImage(spec))
+    {
+        inputs.push_back(spec);
+    }
+    else
+    {
+        // list file, one image per line, # starts a comment
+        std::ifstream list(spec);
+        std::string line;
+
+        while (std::getline(list, line))
+        {
+            line.erase(0, line.find_first_not_of(" \t"));
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            if (!line.empty() && line[0] != '#') inputs.push_back(line);
+        }
+    }
+
+    return inputs;
+}
+
+std::string
+BatchRunner::outputName(const std::string &pattern, const std::string &input,
+                        size_t index) noexcept
+{
+    const fs::path path(input);
+    std::string dir = path.parent_path().string();
+    if (dir.empty()) dir = ".";
+
+    std::string out = pattern;
+    replaceAll(out, "{name}", path.stem().string());
+    replaceAll(out, "{dir}", dir);
+    replaceAll(out, "{index}", std::to_string(index));
+    return out;
+}
+
+std::vector<BatchRunner::Result>
+BatchRunner::run(const std::vector<std::string> &inputs,
+                 MapTemplate *map) noexcept
+{
+    std::vector<Result> results(inputs.size());
+    if (!map || inputs.empty()) return results;
+
+    const unsigned int cores =
+        std::max(1u, std::thread::hardware_concurrency());
+    const unsigned int threads =
+        m_options.threads ? m_options.threads : cores;
+
+    unsigned int jobs = m_options.jobs ? m_options.jobs : threads;
+    if (!map->threadSafe()) jobs = 1;
+    jobs = std::clamp<unsigned int>(jobs, 1, inputs.size());
+
+    // Threads left over once every job has one go to the mapping itself
+    const unsigned int perJob = std::max(1u, threads / jobs);
+
+    std::atomic<size_t> nextIndex{ 0 };
+
+    auto job = [&]()
+    {
+        SonificationEngine engine(perJob);
+        engine.setAngularResolution(m_options.angles);
+        engine.setMemoize(m_options.memoize);
+        engine.setSkipSilent(m_options.skipSilent);
+        engine.setChannels(m_options.channels);
+
+        const std::vector<Pixel> noPath;
+        std::vector<short> audio;
+        Decoded current, next;
+
+        size_t index = nextIndex.fetch_add(1);
+        if (index < inputs.size()) decode(inputs[index], current);
+
+        while (index < inputs.size())
+        {
+            // Claim and decode the next image while this one is mapped
+            const size_t following = nextIndex.fetch_add(1);
+            std::thread prefetch;
+            if (following < inputs.size())
+                prefetch = std::thread(
+                    [&]() { decode(inputs[following], next); });
+
+            Result &r  = results[index];
+            r.input    = inputs[index];
+            r.output   = outputName(m_options.output, r.input, index);
+            r.decodeMs = current.ms;
+
+            if (!current.ok)
+                TraceLog(LOG_ERROR, "Unable to decode %s", r.input.c_str());
+            else
+            {
+                auto start = Clock::now();
+                r.ok = engine.render(current.pixels, m_options.traversal, map,
+                                     noPath, audio);
+                r.renderMs = msSince(start);
+
+                start = Clock::now();
+                std::error_code ec;
+                const fs::path parent = fs::path(r.output).parent_path();
+                if (!parent.empty()) fs::create_directories(parent, ec);
+
+                WavWriter wav;
+                r.ok = r.ok &&
+                       wav.open(r.output,
+                                static_cast<unsigned int>(m_options.sampleRate),
+                                m_options.channels, m_options.format) &&
+                       wav.write(audio);
+                r.ok      = wav.close() && r.ok;
+                r.writeMs = msSince(start);
+                r.seconds = static_cast<double>(audio.size()) /
+                            (m_options.sampleRate * m_options.channels);
+            }
+
+            if (prefetch.joinable()) prefetch.join();
+            std::swap(current, next);
+            index = following;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < jobs; ++i)
+        workers.emplace_back(job);
+    job();
+
+    for (auto &w : workers)
+        w.join();
+
+    return results;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "SonificationEngine.hpp"
+#include "WavWriter.hpp"
+
+#include <string>
+#include <vector>
+
+// Sonifies a list of images in one process, several images at a time. Each
+// job decodes its next image while the current one is being mapped, then
+// writes the audio to a WAV file named after the output pattern.
+class BatchRunner
+{
+public:
+
+    struct Options
+    {
+        TraversalType traversal{ TraversalType::LEFT_TO_RIGHT };
+        unsigned int jobs{ 0 };    // images in flight, 0 = one per core
+        unsigned int threads{ 0 }; // total worker threads, 0 = all cores
+        int angles{ 360 };
+        bool memoize{ false }, skipSilent{ false };
+        float sampleRate{ 44100.0f };
+        unsigned int channels{ 1 };
+        WavWriter::Format format{ WavWriter::Format::PCM16 };
+        std::string output{ "{dir}/{name}.wav" };
+    };
+
+    struct Result
+    {
+        std::string input, output;
+        double decodeMs{ 0 }, renderMs{ 0 }, writeMs{ 0 };
+        double seconds{ 0 }; // of audio
+        bool ok{ false };
+    };
+
+    explicit BatchRunner(const Options &options) noexcept;
+
+    // Images named by `spec`: a directory, a glob pattern, a text file
+    // listing one image per line or a single image
+    static std::vector<std::string>
+    collectInputs(const std::string &spec) noexcept;
+
+    // Replaces `{name}` (file name without extension), `{dir}` and `{index}`
+    // in `pattern`
+    static std::string outputName(const std::string &pattern,
+                                  const std::string &input,
+                                  size_t index) noexcept;
+
+    // Results are in the order of `inputs`. `map` is shared by every job, so
+    // a mapping that is not thread safe runs one image at a time.
+    std::vector<Result> run(const std::vector<std::string> &inputs,
+                            MapTemplate *map) noexcept;
+
+private:
+
+    Options m_options;
+};
@@ -0,0 +1,100 @@
+#include "ColumnMemo.hpp"
+
+#include <cstring>
+
+namespace
+{
+    // FNV-1a over 32-bit words, one RGBA8 pixel (or coordinate) per step
+    constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+    constexpr uint64_t FNV_PRIME  = 0x100000001b3ull;
+
+    inline uint64_t mix(uint64_t h, uint32_t word) noexcept
+    {
+        return (h ^ word) * FNV_PRIME;
+    }
+
+    inline uint32_t word(const unsigned char *p) noexcept
+    {
+        uint32_t w;
+        std::memcpy(&w, p, sizeof(w));
+        return w;
+    }
+
+    template <typename T> inline uint64_t mixValue(uint64_t h, T value) noexcept
+    {
+        unsigned char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        for (unsigned char b : bytes)
+            h = (h ^ b) * FNV_PRIME;
+        return h;
+    }
+} // namespace
+
+ColumnMemo::ColumnMemo(const MapTemplate &map, const Panning &pan) noexcept
+    : m_seed(FNV_OFFSET),
+      m_coords(map.positionDependent() || pan.channels > 1)
+{
+    // Same pixels under different parameters sound different
+    m_seed = mixValue(m_seed, map.minFreq());
+    m_seed = mixValue(m_seed, map.maxFreq());
+    m_seed = mixValue(m_seed, map.sampleRate());
+    m_seed = mixValue(m_seed, map.durationPerSample());
+    m_seed = mixValue(m_seed, map.freqMapper());
+    m_seed = mixValue(m_seed, pan.channels);
+}
+
+uint64_t
+ColumnMemo::key(const PixelView &view, bool &silent) const noexcept
+{
+    uint64_t h = mixValue(m_seed, view.size());
+    silent     = true;
+
+    for (size_t i = 0; i < view.size(); ++i)
+    {
+        const unsigned char *p = view.data(i);
+        h                      = mix(h, word(p));
+        silent = silent && (p[3] == 0 || (p[0] | p[1] | p[2]) == 0);
+    }
+
+    if (m_coords)
+    {
+        h = mixValue(h, view.start());
+        for (size_t i = 0; i < view.size(); ++i)
+        {
+            h = mix(h, static_cast<uint32_t>(view.x(i)));
+            h = mix(h, static_cast<uint32_t>(view.y(i)));
+        }
+    }
+
+    return h;
+}
+
+bool
+ColumnMemo::same(const PixelView &a, const PixelView &b) const noexcept
+{
+    if (a.size() != b.size()) return false;
+    if (m_coords && a.start() != b.start()) return false;
+
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        if (std::memcmp(a.data(i), b.data(i), 4) != 0) return false;
+        if (m_coords && (a.x(i) != b.x(i) || a.y(i) != b.y(i))) return false;
+    }
+
+    return true;
+}
+
+size_t
+ColumnMemo::claim(uint64_t key, size_t column) noexcept
+{
+    auto [it, inserted] = m_first.try_emplace(key, column);
+    return inserted ? NONE : it->second;
+}
+
+ColumnMemo::Stats
+ColumnMemo::stats() const noexcept
+{
+    return { m_hits.load(std::memory_order_relaxed),
+             m_misses.load(std::memory_order_relaxed),
+             m_silent.load(std::memory_order_relaxed) };
+}
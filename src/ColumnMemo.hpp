@@ -0,0 +1,65 @@
+#pragma once
+
+#include "sonify/MapTemplate.hpp"
+#include "sonify/PixelView.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+
+// Content addressed memo of the columns of one plan. Columns are keyed by a
+// hash of their pixels (and coordinates and start, for mappings that look at
+// them)
+// seeded with the mapping parameters; a repeated column copies the samples of
+// the first column with the same key instead of calling the mapping again.
+class ColumnMemo
+{
+public:
+
+    static constexpr size_t NONE = static_cast<size_t>(-1);
+
+    struct Stats
+    {
+        size_t hits{ 0 }, misses{ 0 }, silent{ 0 };
+    };
+
+    // With several channels the pan position makes every column position
+    // dependent
+    ColumnMemo(const MapTemplate &map, const Panning &pan) noexcept;
+
+    // Key of `view`. `silent` is set when every pixel is black or fully
+    // transparent.
+    uint64_t key(const PixelView &view, bool &silent) const noexcept;
+
+    // Whether two columns hashing to the same key really are the same
+    bool same(const PixelView &a, const PixelView &b) const noexcept;
+
+    // Column already claimed for `key`, or NONE after making `column` the one
+    // holding the samples for `key`. Not thread safe.
+    size_t claim(uint64_t key, size_t column) noexcept;
+
+    // Drops the claimed columns, keeping the counters
+    inline void forget() noexcept { m_first.clear(); }
+
+    inline void hit() noexcept
+    {
+        m_hits.fetch_add(1, std::memory_order_relaxed);
+    }
+    inline void miss() noexcept
+    {
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+    }
+    inline void silence() noexcept
+    {
+        m_silent.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Stats stats() const noexcept;
+
+private:
+
+    uint64_t m_seed;
+    bool m_coords; // coordinates are part of the key
+    std::unordered_map<uint64_t, size_t> m_first;
+    std::atomic<size_t> m_hits{ 0 }, m_misses{ 0 }, m_silent{ 0 };
+};
@@ -0,0 +1,263 @@
+#include "FFT.hpp"
+
+#include <cassert>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numbers>
+
+namespace sonify
+{
+    namespace
+    {
+        std::mutex g_plansMutex; // also serializes the FFTW planner
+        std::map<size_t, std::unique_ptr<FFTPlan>> g_plans;
+
+        void bitReversal(size_t n, std::vector<uint32_t> &reverse) noexcept
+        {
+            reverse.resize(n);
+            for (size_t i = 1, j = 0; i < n; i++)
+            {
+                size_t bit = n >> 1;
+                for (; j & bit; bit >>= 1)
+                    j ^= bit;
+                j ^= bit;
+                reverse[i] = static_cast<uint32_t>(j);
+            }
+            if (n) reverse[0] = 0;
+        }
+    } // namespace
+
+    FFTPlan::FFTPlan(size_t size) noexcept : m_size(size)
+    {
+        assert(size >= 2 && (size & (size - 1)) == 0 &&
+               "FFT size must be a power of two!");
+
+        bitReversal(size, m_reverse);
+        bitReversal(size / 2, m_reverseHalf);
+
+        // Every entry is computed directly, multiplying by a rotation
+        // instead accumulates error on large transforms
+        m_twiddles.resize(size - 1);
+        for (size_t len = 2; len <= size; len <<= 1)
+        {
+            const double ang = -2.0 * std::numbers::pi / len;
+            for (size_t j = 0; j < len / 2; j++)
+                m_twiddles[len / 2 - 1 + j] = std::polar(1.0, ang * j);
+        }
+
+#ifdef SONIFY_FFTW
+        // Planned once with scratch arrays, then run on the callers' arrays
+        const int n            = static_cast<int>(size);
+        const unsigned flags   = FFTW_ESTIMATE | FFTW_UNALIGNED;
+        fftw_complex *spectrum = fftw_alloc_complex(size);
+        double *samples        = fftw_alloc_real(size);
+
+        m_forward = fftw_plan_dft_1d(n, spectrum, spectrum, FFTW_FORWARD, flags);
+        m_inverse =
+            fftw_plan_dft_1d(n, spectrum, spectrum, FFTW_BACKWARD, flags);
+        m_forwardReal = fftw_plan_dft_r2c_1d(n, samples, spectrum, flags);
+        m_inverseReal = fftw_plan_dft_c2r_1d(n, spectrum, samples,
+                                             flags | FFTW_PRESERVE_INPUT);
+
+        fftw_free(samples);
+        fftw_free(spectrum);
+#endif
+    }
+
+    FFTPlan::~FFTPlan() noexcept
+    {
+#ifdef SONIFY_FFTW
+        fftw_destroy_plan(m_forward);
+        fftw_destroy_plan(m_inverse);
+        fftw_destroy_plan(m_forwardReal);
+        fftw_destroy_plan(m_inverseReal);
+#endif
+    }
+
+    const FFTPlan &
+    FFTPlan::get(size_t size) noexcept
+    {
+        std::lock_guard lock(g_plansMutex);
+
+        auto &plan = g_plans[size];
+        if (!plan) plan.reset(new FFTPlan(size));
+        return *plan;
+    }
+
+    const char *
+    FFTPlan::backend() noexcept
+    {
+#ifdef SONIFY_FFTW
+        return "fftw";
+#else
+        return "builtin";
+#endif
+    }
+
+    template <bool Inverse>
+    void
+    FFTPlan::transform(complex *a, size_t n,
+                       const uint32_t *reverse) const noexcept
+    {
+        for (size_t i = 1; i < n; i++)
+        {
+            const size_t j = reverse[i];
+            if (i < j) std::swap(a[i], a[j]);
+        }
+
+        // Interleaved re/im, the products are written out so they do not go
+        // through the NaN checks of std::complex multiplication
+        double *d = reinterpret_cast<double *>(a);
+
+        // first stage, all twiddles are 1
+        for (size_t i = 0; i + 1 < n; i += 2)
+        {
+            const double ur = d[2 * i], ui = d[2 * i + 1];
+            const double vr = d[2 * i + 2], vi = d[2 * i + 3];
+            d[2 * i]        = ur + vr;
+            d[2 * i + 1]    = ui + vi;
+            d[2 * i + 2]    = ur - vr;
+            d[2 * i + 3]    = ui - vi;
+        }
+
+        for (size_t len = 4; len <= n; len <<= 1)
+        {
+            const size_t half = len / 2;
+            const double *w =
+                reinterpret_cast<const double *>(m_twiddles.data() + half - 1);
+
+            for (size_t i = 0; i < n; i += len)
+            {
+                double *u = d + 2 * i;
+                double *v = d + 2 * (i + half);
+                for (size_t j = 0; j < half; j++)
+                {
+                    const double wr = w[2 * j];
+                    const double wi = Inverse ? -w[2 * j + 1] : w[2 * j + 1];
+                    const double vr = v[2 * j] * wr - v[2 * j + 1] * wi;
+                    const double vi = v[2 * j] * wi + v[2 * j + 1] * wr;
+                    const double ur = u[2 * j], ui = u[2 * j + 1];
+                    u[2 * j]        = ur + vr;
+                    u[2 * j + 1]    = ui + vi;
+                    v[2 * j]        = ur - vr;
+                    v[2 * j + 1]    = ui - vi;
+                }
+            }
+        }
+
+        if (Inverse)
+        {
+            const double scale = 1.0 / static_cast<double>(n);
+            for (size_t i = 0; i < 2 * n; i++)
+                d[i] *= scale;
+        }
+    }
+
+    void
+    FFTPlan::forward(std::span<complex> a) const noexcept
+    {
+        assert(a.size() == m_size);
+#ifdef SONIFY_FFTW
+        fftw_complex *data = reinterpret_cast<fftw_complex *>(a.data());
+        fftw_execute_dft(m_forward, data, data);
+#else
+        transform<false>(a.data(), m_size, m_reverse.data());
+#endif
+    }
+
+    void
+    FFTPlan::inverse(std::span<complex> a) const noexcept
+    {
+        assert(a.size() == m_size);
+#ifdef SONIFY_FFTW
+        fftw_complex *data = reinterpret_cast<fftw_complex *>(a.data());
+        fftw_execute_dft(m_inverse, data, data);
+        for (complex &x : a)
+            x /= static_cast<double>(m_size);
+#else
+        transform<true>(a.data(), m_size, m_reverse.data());
+#endif
+    }
+
+    void
+    FFTPlan::forwardReal(std::span<const double> in,
+                         std::span<complex> out) const noexcept
+    {
+        assert(in.size() == m_size && out.size() == m_size / 2 + 1);
+#ifdef SONIFY_FFTW
+        fftw_execute_dft_r2c(m_forwardReal, const_cast<double *>(in.data()),
+                             reinterpret_cast<fftw_complex *>(out.data()));
+#else
+        // Even samples as real parts, odd ones as imaginary parts, through a
+        // transform of half the size done in `out`
+        const size_t M = m_size / 2;
+        for (size_t m = 0; m < M; m++)
+            out[m] = complex(in[2 * m], in[2 * m + 1]);
+
+        transform<false>(out.data(), M, m_reverseHalf.data());
+
+        // then the spectra of both halves are separated and recombined
+        const complex z0 = out[0];
+        out[0]           = complex(z0.real() + z0.imag(), 0.0);
+        out[M]           = complex(z0.real() - z0.imag(), 0.0);
+
+        const complex *W = m_twiddles.data() + M - 1; // exp(-2 pi i k / N)
+        for (size_t k = 1; k <= M / 2; k++)
+        {
+            const complex zk = out[k];
+            const complex zm = std::conj(out[M - k]);
+            const complex e  = 0.5 * (zk + zm);
+            const complex d  = 0.5 * (zk - zm);
+            const complex o(d.imag(), -d.real()); // d / i
+
+            const complex wo(W[k].real() * o.real() - W[k].imag() * o.imag(),
+                             W[k].real() * o.imag() + W[k].imag() * o.real());
+            out[k]     = e + wo;
+            out[M - k] = std::conj(e - wo);
+        }
+#endif
+    }
+
+    void
+    FFTPlan::inverseReal(std::span<const complex> in,
+                         std::span<double> out) const noexcept
+    {
+        assert(in.size() == m_size / 2 + 1 && out.size() == m_size);
+#ifdef SONIFY_FFTW
+        fftw_execute_dft_c2r(
+            m_inverseReal,
+            reinterpret_cast<fftw_complex *>(const_cast<complex *>(in.data())),
+            out.data());
+        for (double &x : out)
+            x /= static_cast<double>(m_size);
+#else
+        // Reverse of forwardReal(): the half size spectrum whose inverse
+        // holds the even samples in its real parts and the odd ones in its
+        // imaginary parts, built in `out`
+        const size_t M   = m_size / 2;
+        complex *z       = reinterpret_cast<complex *>(out.data());
+        const complex *W = m_twiddles.data() + M - 1;
+
+        for (size_t k = 0; k <= M / 2; k++)
+        {
+            const complex xk = in[k];
+            const complex xm = std::conj(in[M - k]);
+            const complex e  = 0.5 * (xk + xm);
+            const complex d  = 0.5 * (xk - xm);
+
+            // d * conj(W^k)
+            const complex o(d.real() * W[k].real() + d.imag() * W[k].imag(),
+                            d.imag() * W[k].real() - d.real() * W[k].imag());
+            const complex io(-o.imag(), o.real());
+
+            z[k] = e + io;
+            if (k > 0)
+                z[M - k] = std::conj(e) + complex(o.imag(), o.real());
+        }
+
+        transform<true>(z, M, m_reverseHalf.data());
+#endif
+    }
+
+} // namespace sonify
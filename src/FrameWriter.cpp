@@ -0,0 +1,103 @@
+#include "FrameWriter.hpp"
+
+#include "raylib.h"
+
+#include <algorithm>
+
+FrameWriter::FrameWriter(size_t depth) noexcept
+    : m_depth(std::max<size_t>(1, depth))
+{
+}
+
+FrameWriter::~FrameWriter() noexcept
+{
+    finish();
+}
+
+void
+FrameWriter::start(std::FILE *pipe, size_t frameBytes) noexcept
+{
+    finish();
+
+    m_pipe       = pipe;
+    m_frameBytes = frameBytes;
+    m_written    = 0;
+    m_stop       = false;
+    m_failed     = false;
+    m_free.clear();
+
+    m_thread = std::thread([this]() { writeLoop(); });
+}
+
+FrameWriter::Buffer
+FrameWriter::acquire() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_free.empty())
+        {
+            Buffer b = std::move(m_free.back());
+            m_free.pop_back();
+            return b;
+        }
+    }
+
+    return Buffer(m_frameBytes);
+}
+
+void
+FrameWriter::submit(Buffer &&frame) noexcept
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock, [this]() { return m_queue.size() < m_depth; });
+        m_queue.push_back(std::move(frame));
+    }
+    m_notEmpty.notify_one();
+}
+
+bool
+FrameWriter::finish() noexcept
+{
+    if (!m_thread.joinable()) return !m_failed;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_notEmpty.notify_one();
+    m_thread.join();
+
+    return !m_failed;
+}
+
+void
+FrameWriter::writeLoop() noexcept
+{
+    for (;;)
+    {
+        Buffer frame;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_notEmpty.wait(lock,
+                            [this]() { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty()) return;
+
+            frame = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        m_notFull.notify_one();
+
+        // Keep draining after a failure so that submit() never blocks forever
+        if (!m_failed &&
+            std::fwrite(frame.data(), 1, frame.size(), m_pipe) != frame.size())
+        {
+            TraceLog(LOG_ERROR, "Unable to write video frame to the encoder");
+            m_failed = true;
+        }
+        else if (!m_failed) { ++m_written; }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_free.size() < m_depth) m_free.push_back(std::move(frame));
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Writes raw video frames to an encoder pipe on its own thread. Frames wait in
+// a bounded queue: when the encoder falls behind, submit() blocks instead of
+// dropping frames. Written buffers go back to a free list for acquire().
+class FrameWriter
+{
+public:
+
+    using Buffer = std::vector<unsigned char>;
+
+    explicit FrameWriter(size_t depth = 8) noexcept;
+    ~FrameWriter() noexcept;
+
+    FrameWriter(const FrameWriter &)            = delete;
+    FrameWriter &operator=(const FrameWriter &) = delete;
+
+    void start(std::FILE *pipe, size_t frameBytes) noexcept;
+
+    // A frameBytes sized buffer, recycled when possible
+    Buffer acquire() noexcept;
+
+    // Queues a frame, blocking while the queue is full
+    void submit(Buffer &&frame) noexcept;
+
+    // Writes what is queued and stops the thread. False if a write failed.
+    bool finish() noexcept;
+
+    inline size_t written() const noexcept { return m_written; }
+
+private:
+
+    void writeLoop() noexcept;
+
+    std::FILE *m_pipe{ nullptr };
+    size_t m_frameBytes{ 0 }, m_depth;
+    std::atomic<size_t> m_written{ 0 };
+    bool m_stop{ false }, m_failed{ false };
+
+    std::deque<Buffer> m_queue;
+    std::vector<Buffer> m_free;
+    std::mutex m_mutex;
+    std::condition_variable m_notEmpty, m_notFull;
+    std::thread m_thread;
+};
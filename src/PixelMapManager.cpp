@@ -6,6 +6,8 @@
 
 PixelMapManager::~PixelMapManager() noexcept
 {
+    releaseRetired();
+
     for (auto &p : m_mappings)
     {
 
@@ -111,3 +113,46 @@ PixelMapManager::_removeFromVec(unsigned int id) noexcept
         m_mappings.pop_back(); // remove last element
     }
 }
+
+void
+PixelMapManager::replace(const PixelMap &p) noexcept
+{
+    auto it = std::find_if(m_mappings.begin(), m_mappings.end(),
+                           [&p](const PixelMap &m) -> bool
+    { return m.name == p.name; });
+
+    if (it == m_mappings.end())
+    {
+        m_mappings.push_back(p);
+        return;
+    }
+
+    m_retired.push_back(*it);
+    *it = p;
+}
+
+void
+PixelMapManager::releaseRetired() noexcept
+{
+    for (auto &p : m_retired)
+        release(p);
+    m_retired.clear();
+}
+
+void
+PixelMapManager::release(PixelMap &p) noexcept
+{
+    if (p.map)
+    {
+        // built-in maps have no library to destroy them
+        if (p.destroy) p.destroy(p.map);
+        else delete p.map;
+        p.map = nullptr;
+    }
+
+    if (p.handle)
+    {
+        dlclose(p.handle);
+        p.handle = nullptr;
+    }
+}
@@ -48,8 +48,19 @@ public:
     void remove(const std::string &mapName) noexcept;
     void remove(const char *mapName) noexcept;
 
+    // Puts `p` in place of the map with the same name, or adds it. The
+    // replaced map is retired: renders started before may still be calling
+    // it, it is only destroyed by releaseRetired().
+    void replace(const PixelMap &p) noexcept;
+    void releaseRetired() noexcept;
+    inline bool hasRetired() const noexcept { return !m_retired.empty(); }
+
+    // Destroys the map and closes its library
+    static void release(PixelMap &p) noexcept;
+
 private:
 
     void _removeFromVec(unsigned int id) noexcept;
     std::vector<PixelMap> m_mappings;
+    std::vector<PixelMap> m_retired;
 };
@@ -0,0 +1,295 @@
+#include "PixelStore.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+
+namespace
+{
+    // 64x64 RGBA8 tiles: 16 KiB read + 16 KiB written, which stays within L1
+    constexpr int TILE = 64;
+
+    void transposeTile(const Color *src, Color *dst, int w, int h, int x0,
+                       int y0) noexcept
+    {
+        const int x1 = std::min(x0 + TILE, w);
+        const int y1 = std::min(y0 + TILE, h);
+
+        for (int x = x0; x < x1; ++x)
+        {
+            Color *out      = dst + (size_t)x * h;
+            const Color *in = src + x;
+            for (int y = y0; y < y1; ++y)
+                out[y] = in[(size_t)y * w];
+        }
+    }
+
+    // Bilinear sample at a sub-pixel position inside the image
+    inline Color sampleBilinear(const Color *pixels, int w, int h, float x,
+                                float y) noexcept
+    {
+        const int x0   = std::clamp(static_cast<int>(x), 0, w - 1);
+        const int y0   = std::clamp(static_cast<int>(y), 0, h - 1);
+        const int x1   = std::min(x0 + 1, w - 1);
+        const int y1   = std::min(y0 + 1, h - 1);
+        const float fx = std::clamp(x - x0, 0.0f, 1.0f);
+        const float fy = std::clamp(y - y0, 0.0f, 1.0f);
+
+        const Color &c00 = pixels[(size_t)y0 * w + x0];
+        const Color &c10 = pixels[(size_t)y0 * w + x1];
+        const Color &c01 = pixels[(size_t)y1 * w + x0];
+        const Color &c11 = pixels[(size_t)y1 * w + x1];
+
+        const float w00 = (1.0f - fx) * (1.0f - fy);
+        const float w10 = fx * (1.0f - fy);
+        const float w01 = (1.0f - fx) * fy;
+        const float w11 = fx * fy;
+
+        auto blend = [&](unsigned char a, unsigned char b, unsigned char c,
+                         unsigned char d) -> unsigned char
+        {
+            return static_cast<unsigned char>(a * w00 + b * w10 + c * w01 +
+                                              d * w11 + 0.5f);
+        };
+
+        return Color{ blend(c00.r, c10.r, c01.r, c11.r),
+                      blend(c00.g, c10.g, c01.g, c11.g),
+                      blend(c00.b, c10.b, c01.b, c11.b),
+                      blend(c00.a, c10.a, c01.a, c11.a) };
+    }
+
+    // Number of pixels on the border of a box of the given size
+    inline size_t ringLength(int boxW, int boxH) noexcept
+    {
+        if (boxW <= 0 || boxH <= 0) return 0;
+        if (boxW == 1) return (size_t)boxH;
+        if (boxH == 1) return (size_t)boxW;
+        return 2 * (size_t)boxW + 2 * (size_t)boxH - 4;
+    }
+
+    // Walks the border of the [left, right] x [top, bottom] box clockwise
+    // starting at the top left corner
+    void unwrapRing(const Color *pixels, int w, int left, int right, int top,
+                    int bottom, Color *out, PixelCoord *coords) noexcept
+    {
+        size_t n    = 0;
+        auto append = [&](int x, int y)
+        {
+            out[n]    = pixels[(size_t)y * w + x];
+            coords[n] = { x, y };
+            n++;
+        };
+
+        // Top row: left → right
+        for (int x = left; x <= right; ++x)
+            append(x, top);
+
+        // Right column: top+1 → bottom
+        for (int y = top + 1; y <= bottom; ++y)
+            append(right, y);
+
+        // Bottom row: right-1 → left (if top != bottom)
+        if (top != bottom)
+            for (int x = right - 1; x >= left; --x)
+                append(x, bottom);
+
+        // Left column: bottom-1 → top+1 (if left != right)
+        if (left != right)
+            for (int y = bottom - 1; y > top; --y)
+                append(left, y);
+    }
+} // namespace
+
+bool
+PixelStore::load(const Image &image) noexcept
+{
+    clear();
+
+    if (!IsImageValid(image)) return false;
+
+    m_rows.reset(LoadImageColors(image));
+    if (!m_rows) return false;
+
+    m_width  = image.width;
+    m_height = image.height;
+    return true;
+}
+
+void
+PixelStore::clear() noexcept
+{
+    m_rows.reset();
+    m_columns.clear();
+    m_columns.shrink_to_fit();
+    m_polar = PolarGrid{};
+    for (auto &r : m_rings)
+        r = RingGrid{};
+    m_width  = 0;
+    m_height = 0;
+}
+
+const Color *
+PixelStore::columns(ThreadPool *pool) noexcept
+{
+    if (empty()) return nullptr;
+    if (m_columns.empty()) transpose(pool);
+    return m_columns.data();
+}
+
+void
+PixelStore::transpose(ThreadPool *pool) noexcept
+{
+    const int w = m_width;
+    const int h = m_height;
+
+    m_columns.resize((size_t)w * h);
+
+    const int tilesX   = (w + TILE - 1) / TILE;
+    const int tilesY   = (h + TILE - 1) / TILE;
+    const size_t tiles = (size_t)tilesX * tilesY;
+    const Color *src   = m_rows.get();
+    Color *dst         = m_columns.data();
+
+    // Tiles in a row of tiles write to disjoint column ranges, so every tile
+    // can be transposed independently
+    auto kernel = [=](size_t t, unsigned int)
+    {
+        const int tx = static_cast<int>(t % tilesX);
+        const int ty = static_cast<int>(t / tilesX);
+        transposeTile(src, dst, w, h, tx * TILE, ty * TILE);
+    };
+
+    if (pool)
+        pool->parallelFor(tiles, kernel);
+    else
+        for (size_t t = 0; t < tiles; ++t)
+            kernel(t, 0);
+}
+
+const PolarGrid &
+PixelStore::polar(int angles, ThreadPool *pool) noexcept
+{
+    if (!empty() && angles > 0 && m_polar.angles != angles)
+        resamplePolar(angles, pool);
+    return m_polar;
+}
+
+const RingGrid &
+PixelStore::rings(RingOrder order, ThreadPool *pool) noexcept
+{
+    RingGrid &grid = m_rings[static_cast<int>(order)];
+    if (!empty() && grid.offsets.empty()) unwrapRings(order, pool);
+    return grid;
+}
+
+void
+PixelStore::resamplePolar(int angles, ThreadPool *pool) noexcept
+{
+    const int w = m_width;
+    const int h = m_height;
+
+    PolarGrid &g = m_polar;
+    g.angles     = angles;
+    g.cx         = w / 2;
+    g.cy         = h / 2;
+    g.radii      = static_cast<int>(std::sqrt(g.cx * g.cx + g.cy * g.cy));
+    g.samples.assign((size_t)angles * g.radii, Color{ 0, 0, 0, 0 });
+    g.cosines.resize(angles);
+    g.sines.resize(angles);
+
+    const Color *src = m_rows.get();
+
+    auto ray = [&g, src, w, h](size_t a, unsigned int)
+    {
+        const double rad = 2.0 * M_PI * static_cast<double>(a) / g.angles;
+        const float cosA = static_cast<float>(std::cos(rad));
+        const float sinA = static_cast<float>(std::sin(rad));
+        g.cosines[a]     = cosA;
+        g.sines[a]       = sinA;
+
+        // Small tolerance so that rays along the edges are not cut short by
+        // rounding in cos/sin
+        constexpr float eps = 1e-3f;
+        const float maxX    = static_cast<float>(w - 1) + eps;
+        const float maxY    = static_cast<float>(h - 1) + eps;
+
+        // Past the edge the ray keeps the transparent samples it was
+        // cleared to, it never comes back into the image
+        Color *out = g.samples.data() + a * g.radii;
+        for (int r = 0; r < g.radii; ++r)
+        {
+            const float x = g.cx + r * cosA;
+            const float y = g.cy + r * sinA;
+            if (x < -eps || y < -eps || x > maxX || y > maxY) break;
+            out[r] = sampleBilinear(src, w, h, x, y);
+        }
+    };
+
+    if (pool)
+        pool->parallelFor((size_t)angles, ray);
+    else
+        for (int a = 0; a < angles; ++a)
+            ray((size_t)a, 0);
+}
+
+void
+PixelStore::unwrapRings(RingOrder order, ThreadPool *pool) noexcept
+{
+    const int w = m_width;
+    const int h = m_height;
+
+    // Box of ring r as { left, right, top, bottom }
+    std::function<std::array<int, 4>(int)> box;
+    int count = 0;
+
+    if (order == RingOrder::INWARDS)
+    {
+        // Rings shrink by one pixel on every side until the box collapses
+        count = (std::min(w, h) + 1) / 2;
+        box   = [w, h](int r) -> std::array<int, 4>
+        { return { r, w - 1 - r, r, h - 1 - r }; };
+    }
+    else
+    {
+        const int cx = w / 2;
+        const int cy = h / 2;
+
+        int maxRadius = std::max(cx, w - cx - 1);
+        maxRadius     = std::max(maxRadius, std::max(cy, h - cy - 1));
+
+        count = maxRadius + 1;
+        box   = [w, h, cx, cy](int r) -> std::array<int, 4>
+        {
+            return { std::max(0, cx - r), std::min(w - 1, cx + r),
+                     std::max(0, cy - r), std::min(h - 1, cy + r) };
+        };
+    }
+
+    RingGrid &g = m_rings[static_cast<int>(order)];
+    g.offsets.assign((size_t)count + 1, 0);
+
+    for (int r = 0; r < count; ++r)
+    {
+        const auto [l, rt, t, b] = box(r);
+        g.offsets[r + 1] = g.offsets[r] + ringLength(rt - l + 1, b - t + 1);
+    }
+
+    g.pixels.resize(g.offsets.back());
+    g.coords.resize(g.offsets.back());
+
+    const Color *src = m_rows.get();
+
+    auto unwrap = [&g, &box, src, w](size_t r, unsigned int)
+    {
+        const auto [l, rt, t, b] = box(static_cast<int>(r));
+        unwrapRing(src, w, l, rt, t, b, g.pixels.data() + g.offsets[r],
+                   g.coords.data() + g.offsets[r]);
+    };
+
+    if (pool)
+        pool->parallelFor((size_t)count, unwrap);
+    else
+        for (int r = 0; r < count; ++r)
+            unwrap((size_t)r, 0);
+}
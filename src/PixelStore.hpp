@@ -0,0 +1,101 @@
+#pragma once
+
+#include "ThreadPool.hpp"
+#include "raylib.h"
+#include "sonify/PixelView.hpp"
+
+#include <memory>
+#include <vector>
+
+// Image resampled on an angle x radius grid around the center of the image.
+// Row `a` holds the ray at a * 360 / angles degrees (clockwise on screen),
+// sampled bilinearly once per pixel of radius. Every ray is `radii` long, out
+// to the corners, so all rays last as long; the samples past the edge of the
+// image are transparent black (alpha 0).
+struct PolarGrid
+{
+    int angles{ 0 }, radii{ 0 };
+    int cx{ 0 }, cy{ 0 };
+    std::vector<Color> samples;        // angles x radii, row-major
+    std::vector<float> cosines, sines; // direction of each row
+
+    // Ray `a`, contiguous in memory
+    PixelView row(int a) const noexcept
+    {
+        return PixelView(
+            reinterpret_cast<const unsigned char *>(samples.data() +
+                                                    (size_t)a * radii),
+            (size_t)radii, 1, cx, cy, cosines[a], sines[a]);
+    }
+};
+
+// Concentric rectangular rings unwrapped one after another. Every ring is
+// walked clockwise from its top left corner.
+struct RingGrid
+{
+    std::vector<Color> pixels;
+    std::vector<PixelCoord> coords;
+    std::vector<size_t> offsets; // ring r is [offsets[r], offsets[r + 1])
+
+    inline size_t rings() const noexcept
+    {
+        return offsets.empty() ? 0 : offsets.size() - 1;
+    }
+
+    PixelView ring(size_t r) const noexcept
+    {
+        return PixelView(
+            reinterpret_cast<const unsigned char *>(pixels.data() + offsets[r]),
+            offsets[r + 1] - offsets[r], coords.data() + offsets[r]);
+    }
+};
+
+enum class RingOrder
+{
+    INWARDS = 0, // from the border of the image to its center
+    OUTWARDS     // from the center of the image to its border
+};
+
+// Decoded RGBA8 pixels of the current image. Keeps the row-major pixels
+// around between sonifications and builds, on first use, the layouts the
+// traversals read sequentially: a column-major (transposed) copy for column
+// traversals, a polar grid for rays and unwrapped rings for circles.
+class PixelStore
+{
+public:
+
+    // Copies the pixels of `image`, dropping any previous transposed copy
+    bool load(const Image &image) noexcept;
+    void clear() noexcept;
+
+    inline bool empty() const noexcept { return !m_rows; }
+    inline int width() const noexcept { return m_width; }
+    inline int height() const noexcept { return m_height; }
+
+    // Row-major pixels, pixel (x, y) is at rows()[y * width() + x]
+    inline const Color *rows() const noexcept { return m_rows.get(); }
+
+    // Column-major pixels, pixel (x, y) is at columns()[x * height() + y].
+    // Built on first use and kept until the next load()/clear().
+    const Color *columns(ThreadPool *pool = nullptr) noexcept;
+
+    // Polar resampling with `angles` rays, rebuilt when `angles` changes
+    const PolarGrid &polar(int angles, ThreadPool *pool = nullptr) noexcept;
+
+    const RingGrid &rings(RingOrder order,
+                          ThreadPool *pool = nullptr) noexcept;
+
+private:
+
+    void transpose(ThreadPool *pool) noexcept;
+    void resamplePolar(int angles, ThreadPool *pool) noexcept;
+    void unwrapRings(RingOrder order, ThreadPool *pool) noexcept;
+
+    using ColorsPtr = std::unique_ptr<Color, void (*)(Color *)>;
+
+    ColorsPtr m_rows{ nullptr, UnloadImageColors };
+    std::vector<Color> m_columns;
+    PolarGrid m_polar;
+    RingGrid m_rings[2]; // indexed by RingOrder
+    int m_width{ 0 }, m_height{ 0 };
+};
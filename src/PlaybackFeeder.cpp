@@ -0,0 +1,262 @@
+#include "PlaybackFeeder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+    // about 0.75 s of audio queued ahead of the device at 44.1 kHz
+    constexpr size_t RING_FRAMES = size_t(1) << 15;
+
+    inline void idle() noexcept
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+} // namespace
+
+PlaybackFeeder::PlaybackFeeder(unsigned int channels, Format format) noexcept
+    : m_channels(std::max(channels, 1u)), m_format(format)
+{
+    if (m_format == Format::F32)
+    {
+        m_ring32.resize(RING_FRAMES * m_channels);
+        m_fade32.resize(FADE_FRAMES * m_channels);
+    }
+    else
+    {
+        m_ring16.resize(RING_FRAMES * m_channels);
+        m_fade16.resize(FADE_FRAMES * m_channels);
+    }
+}
+
+bool
+PlaybackFeeder::parseFormat(const std::string &name, Format &format) noexcept
+{
+    if (name == "s16") format = Format::S16;
+    else if (name == "f32") format = Format::F32;
+    else return false;
+
+    return true;
+}
+
+PlaybackFeeder::~PlaybackFeeder() noexcept
+{
+    stop();
+}
+
+void
+PlaybackFeeder::start(const AudioTimeline &audio,
+                      const StreamingRenderer *streamer,
+                      bool crossfade) noexcept
+{
+    stop();
+
+    // same fraction of the old and the new audio
+    uint64_t pos          = m_position.load();
+    const uint64_t length = audio.size();
+    const uint64_t old    = m_length.load();
+    if (crossfade && old && old != length)
+        pos = static_cast<uint64_t>(static_cast<double>(pos) * length / old);
+    pos = std::min(pos, length);
+
+    m_audio     = &audio;
+    m_streamer  = streamer;
+    m_startPos  = pos - pos % m_channels;
+    m_length.store(length);
+    m_seekRequest.store(NO_SEEK);
+    m_ended.store(false);
+    m_stop.store(false);
+
+    // the producer is joined, the ring indices are ours until it starts
+    publishJump(m_format == Format::F32 ? m_ring32.writeIndex()
+                                        : m_ring16.writeIndex(),
+                m_startPos, crossfade);
+    m_position.store(m_startPos, std::memory_order_relaxed);
+
+    m_thread = std::thread([this]() { produce(); });
+}
+
+void
+PlaybackFeeder::stop() noexcept
+{
+    m_stop.store(true);
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void
+PlaybackFeeder::seek(uint64_t pos) noexcept
+{
+    pos -= pos % m_channels;
+    m_seekRequest.store(pos);
+    m_position.store(pos);
+}
+
+void
+PlaybackFeeder::publishJump(size_t index, uint64_t pos, bool fade) noexcept
+{
+    const uint64_t seq = m_jumpSeq.load(std::memory_order_relaxed);
+    m_jumpSeq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_jumpIndex.store(index, std::memory_order_relaxed);
+    m_jumpPos.store(pos, std::memory_order_relaxed);
+    m_jumpFade.store(fade, std::memory_order_relaxed);
+    m_jumpSeq.store(seq + 2, std::memory_order_release);
+}
+
+bool
+PlaybackFeeder::pull(std::span<short> out) noexcept
+{
+    return pullFrom(m_ring16, m_fade16, out);
+}
+
+bool
+PlaybackFeeder::pull(std::span<float> out) noexcept
+{
+    return pullFrom(m_ring32, m_fade32, out);
+}
+
+template <typename T>
+bool
+PlaybackFeeder::pullFrom(SpscRing<T> &ring, std::vector<T> &fade,
+                         std::span<T> out) noexcept
+{
+    // Seqlock read of the latest jump, retried on the next call if the
+    // producer was writing it
+    const uint64_t seq = m_jumpSeq.load(std::memory_order_acquire);
+    if (seq != m_seenSeq && !(seq & 1))
+    {
+        const size_t index = m_jumpIndex.load(std::memory_order_relaxed);
+        const uint64_t pos = m_jumpPos.load(std::memory_order_relaxed);
+        const bool fadeIn  = m_jumpFade.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // A crossfade waits for the new samples while the old ones last
+        const size_t before = index - ring.readIndex();
+        const bool queued   = before <= ring.readable();
+        const bool wait     = fadeIn && queued &&
+                          ring.readable() - before < out.size() &&
+                          before >= out.size() + fade.size();
+
+        if (m_jumpSeq.load(std::memory_order_relaxed) == seq && !wait)
+        {
+            // the start of what was queued before the jump is faded out
+            m_fadeLength = 0;
+            m_fadeDone          = 0;
+            if (fadeIn && queued)
+                m_fadeLength = ring.read(std::span<T>(fade).first(
+                    std::min(before, fade.size())));
+
+            ring.skipTo(index); // samples queued before the jump
+            m_baseIndex = index;
+            m_basePos   = pos;
+            m_seenSeq   = seq;
+        }
+    }
+
+    const size_t n = ring.read(out);
+    std::fill(out.begin() + n, out.end(), T{});
+
+    // Linear crossfade, the gain steps once per frame
+    if (m_fadeDone < m_fadeLength)
+    {
+        const size_t count = std::min(out.size(), m_fadeLength - m_fadeDone);
+        const float step   = static_cast<float>(m_channels) / m_fadeLength;
+        for (size_t i = 0; i < count; i++)
+        {
+            const size_t at = m_fadeDone + i;
+            const float t   = static_cast<float>(at / m_channels) * step;
+            out[i] = static_cast<T>(fade[at] + (out[i] - fade[at]) * t);
+        }
+        m_fadeDone += count;
+    }
+
+    // queued data wraps around to the start when looping
+    const uint64_t length = m_length.load(std::memory_order_relaxed);
+    uint64_t pos          = m_basePos + (ring.readIndex() - m_baseIndex);
+    if (length && pos >= length)
+        pos = m_loop.load(std::memory_order_relaxed) ? pos % length : length;
+
+    // Until its jump is applied the ring still plays the old samples, keep
+    // the target a seek or start already published. The exchange loses to a
+    // seek landing between the check and the store.
+    const bool pending =
+        m_seekRequest.load() != NO_SEEK ||
+        m_jumpSeq.load(std::memory_order_acquire) != m_seenSeq;
+    if (!pending && m_position.compare_exchange_strong(m_published, pos))
+        m_published = pos;
+
+    return n < out.size() && m_ended.load() &&
+           m_seekRequest.load() == NO_SEEK && ring.readable() == 0;
+}
+
+void
+PlaybackFeeder::produce() noexcept
+{
+    if (m_format == Format::F32) produceInto(m_ring32);
+    else produceInto(m_ring16);
+}
+
+template <typename T>
+void
+PlaybackFeeder::produceInto(SpscRing<T> &ring) noexcept
+{
+    std::vector<short> block(BLOCK);
+    std::vector<T> converted(std::is_same_v<T, short> ? 0 : BLOCK);
+    uint64_t pos        = m_startPos;
+    const uint64_t size = m_audio->size();
+
+    while (!m_stop.load())
+    {
+        // cleared only once the jump is out, see pull()
+        const uint64_t request = m_seekRequest.load();
+        if (request != NO_SEEK)
+        {
+            m_ended.store(false);
+            pos = request;
+            publishJump(ring.writeIndex(), pos, false);
+            uint64_t expected = request;
+            m_seekRequest.compare_exchange_strong(expected, NO_SEEK);
+        }
+
+        if (pos >= size)
+        {
+            if (!m_loop.load() || size == 0)
+            {
+                m_ended.store(true);
+                idle();
+                continue;
+            }
+            pos = 0;
+        }
+        m_ended.store(false);
+
+        size_t want =
+            std::min<uint64_t>({ ring.writable(), BLOCK, size - pos });
+        want -= want % m_channels;
+
+        // While streaming, only what the renderer already finished
+        uint64_t end = pos + want;
+        if (m_streamer && m_streamer->active() && !m_streamer->finished())
+            end = std::min(end, m_streamer->readyUntil(pos, want));
+
+        if (end == pos)
+        {
+            idle();
+            continue;
+        }
+
+        const size_t n = static_cast<size_t>(end - pos);
+        m_audio->read(pos, std::span<short>(block.data(), n));
+        if constexpr (std::is_same_v<T, short>)
+            ring.write(std::span<const short>(block.data(), n));
+        else
+        {
+            for (size_t i = 0; i < n; i++)
+                converted[i] = block[i] * (1.0f / 32768.0f);
+            ring.write(std::span<const T>(converted.data(), n));
+        }
+        pos = end;
+    }
+}
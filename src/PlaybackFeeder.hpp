@@ -0,0 +1,115 @@
+#pragma once
+
+#include "AudioTimeline.hpp"
+#include "SpscRing.hpp"
+#include "StreamingRenderer.hpp"
+
+#include <atomic>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Copies the timeline into a lock-free ring on a producer thread, the audio
+// callback only pulls from the ring. The callback therefore never touches
+// the timeline, which can be stopped and reallocated by a new sonification
+// while the device keeps running.
+class PlaybackFeeder
+{
+public:
+
+    // Sample format of the device stream. Float samples are converted on the
+    // producer thread, the callback and the mixer only copy them.
+    enum class Format
+    {
+        S16,
+        F32
+    };
+
+    PlaybackFeeder(unsigned int channels, Format format = Format::S16) noexcept;
+    ~PlaybackFeeder() noexcept;
+
+    // Starts feeding `audio` from position(). While `streamer` renders, only
+    // its finished samples are queued. `audio` must stay put until stop().
+    // With `crossfade`, `audio` replaces the audio played so far: it starts
+    // at the same point of the image, fading over from what was queued.
+    void start(const AudioTimeline &audio, const StreamingRenderer *streamer,
+               bool crossfade = false) noexcept;
+
+    // Joins the producer, what is already queued still gets played
+    void stop() noexcept;
+
+    // Drops the queued samples and continues from `pos`
+    void seek(uint64_t pos) noexcept;
+
+    inline void setLoop(bool loop) noexcept { m_loop.store(loop); }
+    inline Format format() const noexcept { return m_format; }
+
+    // "s16" or "f32"
+    static bool parseFormat(const std::string &name, Format &format) noexcept;
+
+    // Audio thread: fills `out`, silence past what is queued. Returns true
+    // once the end of the audio has been played. Only the overload of
+    // format() has anything queued.
+    bool pull(std::span<short> out) noexcept;
+    bool pull(std::span<float> out) noexcept;
+
+    // Sample position of the audio being played, the target of a seek or
+    // start as soon as it is requested
+    inline uint64_t position() const noexcept
+    {
+        return m_position.load(std::memory_order_relaxed);
+    }
+
+private:
+
+    void produce() noexcept;
+    void publishJump(size_t index, uint64_t pos, bool fade) noexcept;
+    template <typename T> void produceInto(SpscRing<T> &ring) noexcept;
+    template <typename T>
+    bool pullFrom(SpscRing<T> &ring, std::vector<T> &fade,
+                  std::span<T> out) noexcept;
+
+    // samples queued per write, a multiple of every channel count
+    static constexpr size_t BLOCK = 840 * 8;
+    static constexpr uint64_t NO_SEEK = static_cast<uint64_t>(-1);
+    // length of a crossfade, about 46 ms at 44.1 kHz
+    static constexpr size_t FADE_FRAMES = 2048;
+
+    const AudioTimeline *m_audio{ nullptr };
+    const StreamingRenderer *m_streamer{ nullptr };
+    unsigned int m_channels;
+    Format m_format;
+
+    // only the ring of m_format is allocated
+    SpscRing<short> m_ring16;
+    SpscRing<float> m_ring32;
+    std::atomic<uint64_t> m_position{ 0 };
+    std::atomic<uint64_t> m_length{ 0 }; // size of the timeline being fed
+    std::atomic<uint64_t> m_seekRequest{ NO_SEEK };
+    std::atomic<bool> m_loop{ false };
+    std::atomic<bool> m_ended{ false }; // everything up to the end queued
+    std::atomic<bool> m_stop{ false };
+    uint64_t m_startPos{ 0 };  // where the producer starts
+
+    // Where the ring jumps in the timeline: the samples from ring index
+    // `index` on start at sample `pos`, fading in over the samples queued
+    // before them when `fade` is set. Written by the producer (by start()
+    // for the first one) under a sequence count, odd while being written.
+    std::atomic<uint64_t> m_jumpSeq{ 0 };
+    std::atomic<size_t> m_jumpIndex{ 0 };
+    std::atomic<uint64_t> m_jumpPos{ 0 };
+    std::atomic<bool> m_jumpFade{ false };
+
+    // audio thread only
+    uint64_t m_seenSeq{ 0 };
+    size_t m_baseIndex{ 0 };
+    uint64_t m_basePos{ 0 };
+    uint64_t m_published{ 0 }; // last m_position stored by the callback
+    std::vector<short> m_fade16; // old samples being faded out
+    std::vector<float> m_fade32;
+    size_t m_fadeLength{ 0 };
+    size_t m_fadeDone{ 0 };
+
+    std::thread m_thread;
+};
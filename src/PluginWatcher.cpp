@@ -0,0 +1,256 @@
+#include "PluginWatcher.hpp"
+
+#include "raylib.h"
+#include "sonify/PixelView.hpp"
+
+#include <dlfcn.h>
+#include <filesystem>
+#include <poll.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+namespace
+{
+    // The mapping has to produce the column it announces for a short gray
+    // ramp without throwing
+    bool validate(MapTemplate *map) noexcept
+    {
+        constexpr size_t N = 16;
+        unsigned char rgba[N * 4];
+        for (size_t i = 0; i < N; i++)
+        {
+            const unsigned char v = static_cast<unsigned char>(i * 16);
+            rgba[4 * i]           = v;
+            rgba[4 * i + 1]       = v;
+            rgba[4 * i + 2]       = v;
+            rgba[4 * i + 3]       = 255;
+        }
+
+        const PixelView view(rgba, N, 1, 0, 0, 0.0f, 1.0f);
+        const size_t samples = map->columnSamples(view);
+        if (samples == 0 || samples > 60 * map->sampleRate()) return false;
+
+        std::vector<short> out(samples);
+        try
+        {
+            map->mapInto(view, out);
+        }
+        catch (...)
+        {
+            return false;
+        }
+        return true;
+    }
+} // namespace
+
+PluginWatcher::~PluginWatcher() noexcept
+{
+    stop();
+}
+
+bool
+PluginWatcher::start(const std::string &dir) noexcept
+{
+    stop();
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+
+#ifdef __linux__
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd >= 0 && inotify_add_watch(m_fd, dir.c_str(),
+                                       IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+#endif
+    if (m_fd < 0)
+        TraceLog(LOG_WARNING, "Unable to watch %s, mappings are only "
+                              "reloaded with F1", dir.c_str());
+
+    // without inotify the thread still serves reload()
+    m_dir = dir;
+    m_stop.store(false);
+    m_thread = std::thread([this]() { watch(); });
+    return m_fd >= 0;
+}
+
+void
+PluginWatcher::stop() noexcept
+{
+    m_stop.store(true);
+    if (m_thread.joinable()) m_thread.join();
+
+    if (m_fd >= 0) ::close(m_fd);
+    m_fd = -1;
+
+    if (PixelMap *p = m_ready.exchange(nullptr))
+    {
+        PixelMapManager::release(*p);
+        delete p;
+    }
+}
+
+void
+PluginWatcher::reload(const std::string &path) noexcept
+{
+    std::lock_guard lock(m_mutex);
+    m_pending[path] = Clock::time_point{}; // settled already
+}
+
+PixelMap *
+PluginWatcher::take() noexcept
+{
+    return m_ready.exchange(nullptr, std::memory_order_acquire);
+}
+
+void
+PluginWatcher::publish(PixelMap *p) noexcept
+{
+    PixelMap *expected = nullptr;
+    while (!m_ready.compare_exchange_weak(expected, p,
+                                          std::memory_order_release))
+    {
+        if (m_stop.load())
+        {
+            PixelMapManager::release(*p);
+            delete p;
+            return;
+        }
+        expected = nullptr;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+void
+PluginWatcher::watch() noexcept
+{
+    while (!m_stop.load())
+    {
+#ifdef __linux__
+        alignas(inotify_event) char buffer[4096];
+        pollfd pfd{ m_fd, POLLIN, 0 };
+
+        // woken up every 50 ms to look at m_stop and the settled files
+        if (m_fd >= 0 && poll(&pfd, 1, 50) > 0)
+        {
+            const ssize_t len = read(m_fd, buffer, sizeof(buffer));
+            std::lock_guard lock(m_mutex);
+            for (ssize_t i = 0; i < len;)
+            {
+                const auto *e =
+                    reinterpret_cast<const inotify_event *>(buffer + i);
+                const std::string name = e->len ? e->name : "";
+                if (name.ends_with(".so"))
+                    m_pending[(std::filesystem::path(m_dir) / name).string()] =
+                        Clock::now();
+                i += sizeof(inotify_event) + e->len;
+            }
+        }
+        else if (m_fd < 0)
+#endif
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        // the settled paths, loaded without holding the lock
+        std::vector<std::string> paths;
+        {
+            std::lock_guard lock(m_mutex);
+            const auto now = Clock::now();
+            for (auto it = m_pending.begin(); it != m_pending.end();)
+            {
+                if (now - it->second < SETTLE)
+                {
+                    ++it;
+                    continue;
+                }
+                paths.push_back(it->first);
+                it = m_pending.erase(it);
+            }
+        }
+
+        for (const std::string &path : paths)
+        {
+            auto *p = new PixelMap();
+            if (load(path, *p)) publish(p);
+            else delete p;
+        }
+    }
+}
+
+bool
+PluginWatcher::load(const std::string &path, PixelMap &out) noexcept
+{
+    namespace fs = std::filesystem;
+    static std::atomic<unsigned int> copies{ 0 };
+
+    const fs::path source(path);
+    const std::string name = source.stem().string();
+
+    // dlopen() hands out the already loaded library again for a path it
+    // knows, a fresh copy is always loaded anew
+    std::error_code ec;
+    const fs::path copy =
+        fs::temp_directory_path(ec) /
+        ("sonify-" + std::to_string(getpid()) + "-" +
+         std::to_string(copies++) + "-" + source.filename().string());
+    if (!fs::copy_file(source, copy, fs::copy_options::overwrite_existing,
+                       ec))
+    {
+        TraceLog(LOG_WARNING, "Unable to copy %s: %s", path.c_str(),
+                 ec.message().c_str());
+        return false;
+    }
+
+    void *handle = dlopen(copy.c_str(), RTLD_NOW | RTLD_LOCAL);
+    fs::remove(copy, ec); // stays mapped while open
+
+    if (!handle)
+    {
+        TraceLog(LOG_WARNING, "dlopen failed for %s: %s", path.c_str(),
+                 dlerror());
+        return false;
+    }
+
+    auto create  = reinterpret_cast<CreateFn>(dlsym(handle, "create"));
+    auto destroy = reinterpret_cast<DestroyFn>(dlsym(handle, "destroy"));
+
+    if (!create || !destroy)
+    {
+        TraceLog(LOG_WARNING, "Plugin missing create/destroy: %s",
+                 path.c_str());
+        dlclose(handle);
+        return false;
+    }
+
+    // create the map (object exists while lib is loaded)
+    MapTemplate *map = nullptr;
+    try
+    {
+        map = create();
+    }
+    catch (...)
+    {
+        TraceLog(LOG_WARNING, "create() threw exception in %s", path.c_str());
+    }
+
+    if (!map || !validate(map))
+    {
+        TraceLog(LOG_WARNING, "Mapping %s failed validation, keeping the "
+                              "loaded one", path.c_str());
+        if (map) destroy(map);
+        dlclose(handle);
+        return false;
+    }
+
+    out.name    = name;
+    out.handle  = handle;
+    out.map     = map;
+    out.destroy = destroy;
+    return true;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "PixelMapManager.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Watches the mappings directory with inotify and loads the shared objects
+// rebuilt in it on its own thread. A new map is created and tried on a test
+// column before it is handed over, so a broken build never replaces a
+// working one, and the GUI thread only has to swap it in.
+class PluginWatcher
+{
+public:
+
+    PluginWatcher() = default;
+    ~PluginWatcher() noexcept;
+
+    // Starts watching `dir`, created if missing. False without inotify.
+    bool start(const std::string &dir) noexcept;
+    void stop() noexcept;
+
+    // Loads `path` in the background as if it had just been rebuilt
+    void reload(const std::string &path) noexcept;
+
+    // Next validated map, nullptr if none. The caller owns it and its
+    // library from then on.
+    [[nodiscard]] PixelMap *take() noexcept;
+
+    // Opens a private copy of `path`, so that a rebuilt library gets its own
+    // handle while the old one is still loaded, then creates and validates
+    // its map. Safe on any thread.
+    static bool load(const std::string &path, PixelMap &out) noexcept;
+
+private:
+
+    void watch() noexcept;
+    // Hands `p` over once the previous one was taken
+    void publish(PixelMap *p) noexcept;
+
+    using Clock = std::chrono::steady_clock;
+
+    // a rebuild writes the file in several steps, it is loaded once it has
+    // been left alone this long
+    static constexpr std::chrono::milliseconds SETTLE{ 150 };
+
+    std::string m_dir;
+    int m_fd{ -1 };
+
+    std::mutex m_mutex;
+    std::map<std::string, Clock::time_point> m_pending; // path, last change
+
+    std::atomic<PixelMap *> m_ready{ nullptr };
+    std::atomic<bool> m_stop{ false };
+    std::thread m_thread;
+};
@@ -0,0 +1,45 @@
+#include "Resynthesizer.hpp"
+
+Resynthesizer::Resynthesizer(SonificationEngine &engine) noexcept
+    : m_engine(engine)
+{
+}
+
+Resynthesizer::~Resynthesizer() noexcept
+{
+    wait();
+}
+
+void
+Resynthesizer::start(PixelStore &pixels, TraversalType type, MapTemplate *map,
+                     const std::vector<Pixel> &path,
+                     AudioTimeline &out) noexcept
+{
+    wait();
+
+    m_path = path;
+    m_ok   = false;
+    m_done.store(false);
+
+    m_thread = std::thread(
+        [this, &pixels, type, map, &out]()
+        {
+            m_ok = m_engine.render(pixels, type, map, m_path, out);
+            m_done.store(true);
+        });
+}
+
+bool
+Resynthesizer::collect() noexcept
+{
+    if (!m_thread.joinable() || !m_done.load()) return false;
+
+    m_thread.join();
+    return m_ok;
+}
+
+void
+Resynthesizer::wait() noexcept
+{
+    if (m_thread.joinable()) m_thread.join();
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "SonificationEngine.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Renders a whole sonification into a back buffer on its own thread, so that
+// parameters can be changed while the front buffer keeps playing. The engine,
+// the pixels and the map belong to the render until it is collected.
+class Resynthesizer
+{
+public:
+
+    explicit Resynthesizer(SonificationEngine &engine) noexcept;
+    ~Resynthesizer() noexcept;
+
+    // Starts rendering into `out`, after waiting for the previous render
+    void start(PixelStore &pixels, TraversalType type, MapTemplate *map,
+               const std::vector<Pixel> &path, AudioTimeline &out) noexcept;
+
+    // True while a render is running
+    inline bool busy() const noexcept
+    {
+        return m_thread.joinable() && !m_done.load();
+    }
+
+    // Once a render is done: joins it and returns whether it succeeded, the
+    // back buffer is then the caller's again
+    bool collect() noexcept;
+
+    // Blocks until the render is done, dropping its result
+    void wait() noexcept;
+
+private:
+
+    SonificationEngine &m_engine;
+    std::vector<Pixel> m_path; // the path item may change meanwhile
+    std::atomic<bool> m_done{ false };
+    bool m_ok{ false };
+    std::thread m_thread;
+};
@@ -0,0 +1,546 @@
+#include "SonificationEngine.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace
+{
+    inline const unsigned char *bytes(const Color *pixels) noexcept
+    {
+        return reinterpret_cast<const unsigned char *>(pixels);
+    }
+} // namespace
+
+size_t
+SonificationEngine::Plan::columnAt(size_t sample) const noexcept
+{
+    if (columns == 0) return 0;
+
+    // first column ending after `sample`
+    auto it = std::upper_bound(offsets.begin() + 1, offsets.end(), sample);
+    return std::min<size_t>(std::distance(offsets.begin() + 1, it),
+                            columns - 1);
+}
+
+PixelView
+SonificationEngine::Plan::view(size_t i, Scratch &scratch) const noexcept
+{
+    PixelView v = gather(i, scratch);
+    v.setStart(offsets[i] / std::max(1u, pan.channels));
+    return v;
+}
+
+SonificationEngine::SonificationEngine(unsigned int threads) noexcept
+{
+    setThreads(threads);
+}
+
+void
+SonificationEngine::setAngularResolution(int angles) noexcept
+{
+    m_angles = std::max(1, angles);
+}
+
+void
+SonificationEngine::setThreads(unsigned int threads) noexcept
+{
+    if (m_pool && threads != 0 && threads == m_pool->size()) return;
+    m_pool = std::make_unique<ThreadPool>(threads);
+}
+
+bool
+SonificationEngine::render(PixelStore &store, TraversalType type,
+                           MapTemplate *map, const std::vector<Pixel> &path,
+                           std::vector<short> &audio) noexcept
+{
+    Plan p;
+    if (!plan(store, type, map, path, p))
+    {
+        audio.clear();
+        return false;
+    }
+
+    audio.resize(p.samples());
+    renderRange(p, 0, p.columns, audio.data());
+    return true;
+}
+
+bool
+SonificationEngine::render(PixelStore &store, TraversalType type,
+                           MapTemplate *map, const std::vector<Pixel> &path,
+                           AudioTimeline &audio) noexcept
+{
+    Plan p;
+    if (!plan(store, type, map, path, p) ||
+        !audio.allocate(p.samples(), p.offsets))
+    {
+        audio.clear();
+        return false;
+    }
+
+    renderRange(p, 0, p.columns, audio);
+    return true;
+}
+
+bool
+SonificationEngine::plan(PixelStore &store, TraversalType type,
+                         MapTemplate *map, const std::vector<Pixel> &path,
+                         Plan &plan) noexcept
+{
+    plan = Plan{};
+
+    if (!map || store.empty()) return false;
+
+    plan.map = map;
+
+    const Color *pixels = store.rows();
+    const int w         = store.width();
+    const int h         = store.height();
+
+    // rings and rays are placed around the center, the others left to right
+    const bool polar = type == TraversalType::CIRCLE_INWARDS ||
+                       type == TraversalType::CIRCLE_OUTWARDS ||
+                       type == TraversalType::CLOCKWISE ||
+                       type == TraversalType::ANTICLOCKWISE;
+    plan.pan = Panning{ m_channels, w, h, polar };
+
+    switch (type)
+    {
+        case TraversalType::LEFT_TO_RIGHT:
+            collectLeftToRight(store.columns(m_pool.get()), w, h, plan);
+            break;
+
+        case TraversalType::RIGHT_TO_LEFT:
+            collectRightToLeft(store.columns(m_pool.get()), w, h, plan);
+            break;
+
+        case TraversalType::TOP_TO_BOTTOM:
+            collectTopToBottom(pixels, w, h, plan);
+            break;
+
+        case TraversalType::BOTTOM_TO_TOP:
+            collectBottomToTop(pixels, w, h, plan);
+            break;
+
+        case TraversalType::CIRCLE_INWARDS:
+            collectRings(store.rings(RingOrder::INWARDS, m_pool.get()), plan);
+            break;
+
+        case TraversalType::CIRCLE_OUTWARDS:
+            collectRings(store.rings(RingOrder::OUTWARDS, m_pool.get()), plan);
+            break;
+
+        case TraversalType::CLOCKWISE:
+            collectClockwise(store.polar(m_angles, m_pool.get()), plan);
+            break;
+
+        case TraversalType::ANTICLOCKWISE:
+            collectAntiClockwise(store.polar(m_angles, m_pool.get()), plan);
+            break;
+
+        case TraversalType::PATH: collectPath(path, plan); break;
+
+        case TraversalType::REGION: break;
+    }
+
+    if ((m_memoize && map->threadSafe()) || m_skipSilent)
+        plan.memo = std::make_shared<ColumnMemo>(*map, plan.pan);
+    m_memo = plan.memo;
+
+    layout(plan);
+    return true;
+}
+
+void
+SonificationEngine::layout(Plan &plan) noexcept
+{
+    plan.offsets.assign(plan.columns + 1, 0);
+
+    Scratch scratch;
+    for (size_t i = 0; i < plan.columns; ++i)
+    {
+        scratch.pixels.clear();
+        const size_t frames = plan.map->columnSamples(plan.gather(i, scratch));
+        plan.offsets[i + 1] = plan.offsets[i] + frames * plan.pan.channels;
+    }
+}
+
+bool
+SonificationEngine::renderBands(BandReader &reader, TraversalType type,
+                                MapTemplate *map, int bandRows,
+                                const Sink &sink) noexcept
+{
+    if (!map || !reader.isOpen()) return false;
+    if (type != TraversalType::TOP_TO_BOTTOM &&
+        type != TraversalType::BOTTOM_TO_TOP)
+        return false;
+
+    const bool upwards = type == TraversalType::BOTTOM_TO_TOP;
+    const int64_t w    = reader.width();
+    const int64_t h    = reader.height();
+    bandRows           = std::max(1, bandRows);
+    const int64_t n    = (h + bandRows - 1) / bandRows;
+
+    // Rows [first, first + rows) of band b, counted from the bottom when
+    // walking upwards
+    auto band = [=](int64_t b, int64_t &first, int &rows)
+    {
+        const int64_t begin = b * bandRows;
+        rows  = static_cast<int>(std::min<int64_t>(bandRows, h - begin));
+        first = upwards ? h - begin - rows : begin;
+    };
+
+    const Panning pan{ m_channels, static_cast<int>(w), static_cast<int>(h),
+                       false };
+
+    std::shared_ptr<ColumnMemo> memo;
+    if ((m_memoize && map->threadSafe()) || m_skipSilent)
+        memo = std::make_shared<ColumnMemo>(*map, pan);
+    m_memo = memo;
+
+    std::vector<Color> current, next;
+    std::vector<short> audio;
+
+    int64_t first;
+    int rows;
+    band(0, first, rows);
+    current.resize(static_cast<size_t>(w) * rows);
+    if (!reader.read(first, rows, current.data())) return false;
+
+    for (int64_t b = 0; b < n; ++b)
+    {
+        // Decode the next band while this one is mapped
+        bool nextOk = true;
+        std::thread prefetch;
+        if (b + 1 < n)
+        {
+            prefetch = std::thread([&, b]()
+            {
+                int64_t f;
+                int r;
+                band(b + 1, f, r);
+                next.resize(static_cast<size_t>(w) * r);
+                nextOk = reader.read(f, r, next.data());
+            });
+        }
+
+        Plan plan;
+        plan.map     = map;
+        plan.memo    = memo;
+        plan.pan     = pan;
+        plan.columns = static_cast<size_t>(rows);
+
+        const Color *pixels = current.data();
+        const int y0        = static_cast<int>(first);
+        const int count     = rows;
+        plan.gather = [pixels, w, y0, count, upwards](size_t i,
+                                                      Scratch &) -> PixelView
+        {
+            const int r = upwards ? count - 1 - static_cast<int>(i)
+                                  : static_cast<int>(i);
+            return PixelView(bytes(pixels + static_cast<size_t>(r) * w),
+                             static_cast<size_t>(w), 1, 0, y0 + r, 1.0f, 0.0f);
+        };
+
+        // samples of an earlier band are gone, only reuse within this one
+        if (memo) memo->forget();
+        layout(plan);
+
+        audio.resize(plan.samples());
+        renderRange(plan, 0, plan.columns, audio.data());
+
+        if (prefetch.joinable()) prefetch.join();
+
+        if (!sink(audio) || !nextOk) return false;
+
+        if (b + 1 < n)
+        {
+            std::swap(current, next);
+            band(b + 1, first, rows);
+        }
+    }
+
+    return true;
+}
+
+ColumnMemo::Stats
+SonificationEngine::memoStats() const noexcept
+{
+    return m_memo ? m_memo->stats() : ColumnMemo::Stats{};
+}
+
+void
+SonificationEngine::forEach(size_t count, bool parallel,
+                            const ColumnFunc &func) noexcept
+{
+    if (!parallel || m_pool->size() == 1)
+    {
+        Scratch a, b;
+        for (size_t i = 0; i < count; ++i)
+            func(i, a, b);
+        return;
+    }
+
+    const unsigned int n = m_pool->size();
+    std::vector<Scratch> scratch(2 * n);
+    m_pool->parallelFor(count, [&](size_t i, unsigned int worker)
+    { func(i, scratch[worker], scratch[n + worker]); });
+}
+
+void
+SonificationEngine::renderRange(const Plan &plan, size_t first, size_t last,
+                                short *out) noexcept
+{
+    renderSlots(plan, first, last, [&plan, out](size_t i)
+    {
+        return std::span<short>(out + plan.offsets[i],
+                                plan.offsets[i + 1] - plan.offsets[i]);
+    });
+}
+
+void
+SonificationEngine::renderRange(const Plan &plan, size_t first, size_t last,
+                                AudioTimeline &audio) noexcept
+{
+    renderSlots(plan, first, last, [&plan, &audio](size_t i)
+    { return audio.range(plan.offsets[i], plan.offsets[i + 1]); });
+}
+
+bool
+SonificationEngine::renderStream(const Plan &plan, size_t blockSamples,
+                                 const Sink &sink) noexcept
+{
+    if (!plan.map) return false;
+
+    blockSamples = std::max<size_t>(1, blockSamples);
+
+    std::vector<short> current, writing;
+    std::thread writer;
+    bool written = true;
+
+    for (size_t first = 0; first < plan.columns;)
+    {
+        // whole columns, at least one per block
+        size_t last = first + 1;
+        while (last < plan.columns &&
+               plan.offsets[last + 1] - plan.offsets[first] <= blockSamples)
+            ++last;
+
+        // samples of an earlier block are gone, only reuse within this one
+        if (plan.memo) plan.memo->forget();
+
+        const size_t base = plan.offsets[first];
+        current.resize(plan.offsets[last] - base);
+        renderSlots(plan, first, last, [&plan, &current, base](size_t i)
+        {
+            return std::span<short>(current.data() + (plan.offsets[i] - base),
+                                    plan.offsets[i + 1] - plan.offsets[i]);
+        });
+
+        if (writer.joinable()) writer.join();
+        if (!written) return false;
+
+        std::swap(current, writing);
+        writer = std::thread([&]() { written = sink(writing); });
+        first  = last;
+    }
+
+    if (writer.joinable()) writer.join();
+    return written;
+}
+
+void
+SonificationEngine::renderSlots(const Plan &plan, size_t first, size_t last,
+                                const SlotFunc &slot) noexcept
+{
+    last = std::min(last, plan.columns);
+    if (first >= last) return;
+
+    if (plan.memo)
+    {
+        renderMemoized(plan, first, last, slot);
+        return;
+    }
+
+    // Slots are disjoint, workers never write to the same samples. Plugins
+    // that keep state between calls opt out of the parallel path.
+    forEach(last - first, plan.map->threadSafe(),
+            [&plan, first, &slot](size_t i, Scratch &s, Scratch &)
+    {
+        i += first;
+        s.pixels.clear();
+        plan.map->mapInto(plan.view(i, s), slot(i), plan.pan);
+    });
+}
+
+void
+SonificationEngine::renderMemoized(const Plan &plan, size_t first,
+                                   size_t last, const SlotFunc &slot) noexcept
+{
+    const size_t count = last - first;
+    ColumnMemo &memo   = *plan.memo;
+    const bool reuse   = m_memoize && plan.map->threadSafe();
+
+    // Hash every column
+    std::vector<uint64_t> keys(count);
+    std::vector<unsigned char> silent(count);
+    forEach(count, true, [&](size_t k, Scratch &s, Scratch &)
+    {
+        s.pixels.clear();
+        bool blank = false;
+        keys[k]    = memo.key(plan.view(first + k, s), blank);
+        silent[k]  = blank && m_skipSilent;
+    });
+
+    // The first column with a given key gets mapped, later ones (here or in
+    // a later range of the same plan) copy its samples
+    std::vector<size_t> source(count, ColumnMemo::NONE);
+    std::vector<size_t> fresh;
+    for (size_t k = 0; k < count; ++k)
+    {
+        if (silent[k]) continue;
+        if (reuse) source[k] = memo.claim(keys[k], first + k);
+        if (source[k] == ColumnMemo::NONE) fresh.push_back(first + k);
+    }
+
+    forEach(fresh.size(), plan.map->threadSafe(),
+            [&](size_t j, Scratch &s, Scratch &)
+    {
+        s.pixels.clear();
+        plan.map->mapInto(plan.view(fresh[j], s), slot(fresh[j]),
+                          plan.pan);
+        memo.miss();
+    });
+
+    forEach(count, true, [&](size_t k, Scratch &a, Scratch &b)
+    {
+        const size_t i = first + k;
+        auto dst       = slot(i);
+
+        if (silent[k])
+        {
+            std::fill(dst.begin(), dst.end(), 0);
+            memo.silence();
+            return;
+        }
+
+        const size_t src = source[k];
+        if (src == ColumnMemo::NONE) return;
+
+        // Guard against hash collisions before copying
+        a.pixels.clear();
+        b.pixels.clear();
+        const PixelView view = plan.view(i, a);
+        auto from            = slot(src);
+        if (from.size() == dst.size() && memo.same(view, plan.view(src, b)))
+        {
+            std::copy(from.begin(), from.end(), dst.begin());
+            memo.hit();
+            return;
+        }
+
+        plan.map->mapInto(view, dst, plan.pan);
+        memo.miss();
+    });
+}
+
+void
+SonificationEngine::collectLeftToRight(const Color *columns, int w, int h,
+                                       Plan &plan) noexcept
+{
+    plan.columns = (size_t)w;
+    plan.gather  = [columns, h](size_t i, Scratch &) -> PixelView
+    {
+        const int x = static_cast<int>(i);
+        return PixelView(bytes(columns + (size_t)x * h), (size_t)h, 1, x, 0,
+                         0.0f, 1.0f);
+    };
+}
+
+void
+SonificationEngine::collectRightToLeft(const Color *columns, int w, int h,
+                                       Plan &plan) noexcept
+{
+    plan.columns = (size_t)w;
+    plan.gather  = [columns, w, h](size_t i, Scratch &) -> PixelView
+    {
+        const int x = w - 1 - static_cast<int>(i);
+        return PixelView(bytes(columns + (size_t)x * h), (size_t)h, 1, x, 0,
+                         0.0f, 1.0f);
+    };
+}
+
+void
+SonificationEngine::collectTopToBottom(const Color *pixels, int w, int h,
+                                       Plan &plan) noexcept
+{
+    plan.columns = (size_t)h;
+    plan.gather  = [pixels, w](size_t i, Scratch &) -> PixelView
+    {
+        const int y = static_cast<int>(i);
+        return PixelView(bytes(pixels + (size_t)y * w), (size_t)w, 1, 0, y,
+                         1.0f, 0.0f);
+    };
+}
+
+void
+SonificationEngine::collectBottomToTop(const Color *pixels, int w, int h,
+                                       Plan &plan) noexcept
+{
+    plan.columns = (size_t)h;
+    plan.gather  = [pixels, w, h](size_t i, Scratch &) -> PixelView
+    {
+        const int y = h - 1 - static_cast<int>(i);
+        return PixelView(bytes(pixels + (size_t)y * w), (size_t)w, 1, 0, y,
+                         1.0f, 0.0f);
+    };
+}
+
+void
+SonificationEngine::collectRings(const RingGrid &rings, Plan &plan) noexcept
+{
+    plan.columns = rings.rings();
+    plan.gather  = [&rings](size_t i, Scratch &) -> PixelView
+    { return rings.ring(i); };
+}
+
+void
+SonificationEngine::collectClockwise(const PolarGrid &polar,
+                                     Plan &plan) noexcept
+{
+    plan.columns = (size_t)polar.angles;
+    plan.gather  = [&polar](size_t i, Scratch &) -> PixelView
+    { return polar.row(static_cast<int>(i)); };
+}
+
+void
+SonificationEngine::collectAntiClockwise(const PolarGrid &polar,
+                                         Plan &plan) noexcept
+{
+    // Same rays walked the other way round: -angle is row (angles - a)
+    plan.columns = (size_t)polar.angles;
+    plan.gather  = [&polar](size_t i, Scratch &) -> PixelView
+    {
+        const int a = static_cast<int>(i);
+        return polar.row((polar.angles - a) % polar.angles);
+    };
+}
+
+void
+SonificationEngine::collectPath(const std::vector<Pixel> &path,
+                                Plan &plan) noexcept
+{
+    // Repeat pixel 10 times for more audio: a single packed pixel viewed
+    // with a zero stride. The path is copied as the user may keep drawing
+    // while a plan is being rendered.
+    plan.columns = path.size();
+    plan.gather  = [path](size_t i, Scratch &s) -> PixelView
+    {
+        const Pixel &p = path[i];
+        s.pixels.push_back({ static_cast<unsigned char>(p.rgba.r),
+                             static_cast<unsigned char>(p.rgba.g),
+                             static_cast<unsigned char>(p.rgba.b),
+                             static_cast<unsigned char>(p.rgba.a) });
+        return PixelView(bytes(s.pixels.data()), 10, 0, p.x, p.y, 0.0f, 0.0f);
+    };
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "AudioTimeline.hpp"
+#include "BandReader.hpp"
+#include "ColumnMemo.hpp"
+#include "PixelStore.hpp"
+#include "ThreadPool.hpp"
+#include "raylib.h"
+#include "sonify/MapTemplate.hpp"
+#include "sonify/Pixel.hpp"
+#include "sonify/PixelView.hpp"
+
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+enum class TraversalType
+{
+    LEFT_TO_RIGHT = 0,
+    RIGHT_TO_LEFT,
+    TOP_TO_BOTTOM,
+    BOTTOM_TO_TOP,
+    CIRCLE_INWARDS,
+    CIRCLE_OUTWARDS,
+    CLOCKWISE,
+    ANTICLOCKWISE,
+    PATH,
+    REGION
+};
+
+// Turns the pixels of an image into audio. Every traversal is described as a
+// number of columns plus a function returning a PixelView of one column, the
+// columns are then mapped independently, either serially or spread across a
+// worker pool. The offset of every column in the timeline is known up front,
+// so each mapping writes straight into its own slot of a single buffer and the
+// result is the same in both cases.
+class SonificationEngine
+{
+public:
+
+    // Traversals that cannot be viewed in place pack their pixels here, one
+    // Scratch per worker
+    struct Scratch
+    {
+        std::vector<Color> pixels;
+    };
+
+    using Gather = std::function<PixelView(size_t column, Scratch &)>;
+
+    // Columns of a traversal and where their samples go in the timeline. The
+    // views handed out by `gather` point into the PixelStore the plan was made
+    // from, which has to outlive the plan.
+    struct Plan
+    {
+        size_t columns{ 0 };
+        Gather gather;
+        MapTemplate *map{ nullptr };
+        std::vector<size_t> offsets; // column i is [offsets[i], offsets[i+1])
+        std::shared_ptr<ColumnMemo> memo; // null unless memoization is on
+        Panning pan; // output channels, offsets count interleaved samples
+
+        inline size_t samples() const noexcept
+        {
+            return offsets.empty() ? 0 : offsets.back();
+        }
+
+        // Column whose samples contain `sample`
+        size_t columnAt(size_t sample) const noexcept;
+
+        // View of column `i` as handed to the mapping, with its start frame
+        PixelView view(size_t i, Scratch &scratch) const noexcept;
+    };
+
+    // threads = 0 picks the hardware concurrency
+    explicit SonificationEngine(unsigned int threads = 0) noexcept;
+
+    void setThreads(unsigned int threads) noexcept;
+    inline unsigned int threads() const noexcept { return m_pool->size(); }
+    inline ThreadPool &pool() noexcept { return *m_pool; }
+
+    // Reuse the samples of repeated columns within a plan. Only applies to
+    // thread safe mappings, stateful ones may not give the same output twice.
+    inline void setMemoize(bool memoize) noexcept { m_memoize = memoize; }
+    inline bool memoize() const noexcept { return m_memoize; }
+
+    // Emit silence for columns that are all black or fully transparent
+    // without calling the mapping
+    inline void setSkipSilent(bool skip) noexcept { m_skipSilent = skip; }
+    inline bool skipSilent() const noexcept { return m_skipSilent; }
+
+    // Counters of the last plan, zero when it had no memo
+    ColumnMemo::Stats memoStats() const noexcept;
+
+    // Interleaved output channels, each column is panned between them by
+    // its position (see Panning and MapTemplate::mapInto)
+    inline void setChannels(unsigned int channels) noexcept
+    {
+        m_channels = std::max(1u, channels);
+    }
+    inline unsigned int channels() const noexcept { return m_channels; }
+
+    // Number of rays of the CLOCKWISE/ANTICLOCKWISE traversals
+    void setAngularResolution(int angles) noexcept;
+    inline int angularResolution() const noexcept { return m_angles; }
+
+    // Maps the whole traversal into `audio`, resized to the timeline. `path`
+    // is only used by TraversalType::PATH. Column traversals make the store
+    // build (and keep) its transposed copy.
+    bool render(PixelStore &store, TraversalType type, MapTemplate *map,
+                const std::vector<Pixel> &path,
+                std::vector<short> &audio) noexcept;
+
+    // Same, into a chunked timeline whose chunks are cut between columns
+    bool render(PixelStore &store, TraversalType type, MapTemplate *map,
+                const std::vector<Pixel> &path, AudioTimeline &audio) noexcept;
+
+    // Describes the traversal and lays out the timeline without mapping any
+    // column yet
+    bool plan(PixelStore &store, TraversalType type, MapTemplate *map,
+              const std::vector<Pixel> &path, Plan &plan) noexcept;
+
+    using Sink = std::function<bool(std::span<const short> samples)>;
+
+    // Out-of-core TOP_TO_BOTTOM/BOTTOM_TO_TOP traversal: decodes `bandRows`
+    // rows at a time from `reader` (the next band while the current one is
+    // being mapped), maps them and hands the samples of each band to `sink`
+    // in order. Memory use is bounded by two bands, not by the image.
+    bool renderBands(BandReader &reader, TraversalType type, MapTemplate *map,
+                     int bandRows, const Sink &sink) noexcept;
+
+    // Maps the columns [first, last) of `plan` into `out`, which holds the
+    // whole timeline, through MapTemplate::mapInto
+    void renderRange(const Plan &plan, size_t first, size_t last,
+                     short *out) noexcept;
+
+    // Same, `audio` having been allocated with the offsets of `plan` as cuts
+    void renderRange(const Plan &plan, size_t first, size_t last,
+                     AudioTimeline &audio) noexcept;
+
+    // Maps `plan` in blocks of whole columns of about `blockSamples` samples
+    // and hands every block to `sink` in order. The sink runs on its own
+    // thread while the next block is mapped; memory use is two blocks.
+    bool renderStream(const Plan &plan, size_t blockSamples,
+                      const Sink &sink) noexcept;
+
+private:
+
+    using ColumnFunc =
+        std::function<void(size_t index, Scratch &, Scratch &)>;
+
+    // Samples of column `index` in the output
+    using SlotFunc = std::function<std::span<short>(size_t index)>;
+
+    // Runs `func` over [0, count) on the pool, or serially, with two scratch
+    // buffers per thread
+    void forEach(size_t count, bool parallel, const ColumnFunc &func) noexcept;
+
+    // Fills plan.offsets (and plan.memo) once columns/gather are set
+    void layout(Plan &plan) noexcept;
+
+    // Like renderRange, writing every column where `slot` says
+    void renderSlots(const Plan &plan, size_t first, size_t last,
+                     const SlotFunc &slot) noexcept;
+
+    void renderMemoized(const Plan &plan, size_t first, size_t last,
+                        const SlotFunc &slot) noexcept;
+
+    // `columns` is the column-major copy of the image
+    void collectLeftToRight(const Color *columns, int w, int h,
+                            Plan &plan) noexcept;
+
+    void collectRightToLeft(const Color *columns, int w, int h,
+                            Plan &plan) noexcept;
+
+    void collectTopToBottom(const Color *pixels, int w, int h,
+                            Plan &plan) noexcept;
+
+    void collectBottomToTop(const Color *pixels, int w, int h,
+                            Plan &plan) noexcept;
+
+    void collectRings(const RingGrid &rings, Plan &plan) noexcept;
+
+    void collectClockwise(const PolarGrid &polar, Plan &plan) noexcept;
+
+    void collectAntiClockwise(const PolarGrid &polar, Plan &plan) noexcept;
+
+    void collectPath(const std::vector<Pixel> &path, Plan &plan) noexcept;
+
+    std::unique_ptr<ThreadPool> m_pool;
+    std::shared_ptr<ColumnMemo> m_memo; // of the last plan, for memoStats()
+    int m_angles{ 360 };
+    unsigned int m_channels{ 1 };
+    bool m_memoize{ false }, m_skipSilent{ false };
+};
@@ -1,94 +1,347 @@
 #include "Sonify.hpp"
 
+#include "BandReader.hpp"
+#include "BatchRunner.hpp"
 #include "DTexture.hpp"
+#include "FrameWriter.hpp"
 #include "FFT.hpp"
 #include "PixelMapManager.hpp"
+#include "VideoRenderer.hpp"
+#include "WavWriter.hpp"
 #include "ffmpeg.hpp"
 #include "raylib.h"
 #include "sonify/DefaultPixelMappings/IntensityMap.hpp"
+#include "sonify/Wavetable.hpp"
 #include "sonify/utils.hpp"
 #include "toml.hpp"
 
 #define RAYGUI_IMPLEMENTATION
 #include "raygui.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <csignal>
+#include <cstdarg>
 #include <cstdio>
 #include <cstring>
-#include <dlfcn.h>
 #include <filesystem>
 #include <functional>
+#include <thread>
 #include <sonify/DefaultPixelMappings/FiveSegment.hpp>
 
+namespace
+{
+    // With `-o -` stdout carries the audio, messages go to stderr
+    void traceToStderr(int level, const char *text, va_list args)
+    {
+        static const char *names[] = { "",        "TRACE: ", "DEBUG: ",
+                                       "INFO: ",  "WARNING: ", "ERROR: ",
+                                       "FATAL: ", "" };
+        std::fputs(names[std::clamp(level, 0, 7)], stderr);
+        std::vfprintf(stderr, text, args);
+        std::fputc('\n', stderr);
+    }
+
+    inline int64_t steadyNs() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // --low-latency starts here, raylib raises it to the device period
+    constexpr unsigned int LOW_LATENCY_FRAMES = 256;
+    constexpr unsigned int MAX_BUFFER_FRAMES  = 8192;
+
+    // edits closer together than this are rendered once
+    constexpr double RESYNTH_DELAY = 0.15;
+} // namespace
+
 Sonify::Sonify(const argparse::ArgumentParser &args) noexcept
 {
     readConfigFile();
     parse_args(args);
 
+#ifdef NDEBUG
+    SetTraceLogLevel(LOG_NONE);
+#endif
+
+    if (m_outputFileName == "-") SetTraceLogCallback(traceToStderr);
+
+    // before any column is mapped, on whichever thread
+    Wavetable::prepare();
+
+    gInstance = this;
+
+    // Batch runs need neither a window nor an audio device, only the
+    // mappings, loaded once for every image
+    if (!m_batchInput.empty())
+    {
+        m_pixelMapManager = new PixelMapManager();
+        loadDefaultPixelMappings();
+        loadUserPixelMappings();
+        runBatch();
+        return;
+    }
+
+    if (m_headless)
+    {
+        runHeadless();
+        return;
+    }
+
     m_window_config_flags =
         FLAG_WINDOW_RESIZABLE | FLAG_MSAA_4X_HINT | FLAG_VSYNC_HINT;
 
-    if (m_headless) m_window_config_flags &= FLAG_WINDOW_HIDDEN;
     SetConfigFlags(m_window_config_flags);
-#ifdef NDEBUG
-    SetTraceLogLevel(LOG_NONE);
-#endif
     // SetTraceLogLevel(LOG_NONE);
     InitWindow(0, 0, "Sonify");
 
-    if (!m_headless)
-    {
-        SetTargetFPS(m_fps);
-        SetWindowMinSize(1000, 600);
-        m_screenW = GetScreenWidth();
-        m_screenH = GetScreenHeight();
-        m_font    = LoadFontEx(m_font_family.c_str(), m_font_size, 0, 0);
-        if (!IsFontValid(m_font)) { m_font = GetFontDefault(); }
+    SetTargetFPS(m_fps);
+    SetWindowMinSize(1000, 600);
+    m_screenW = GetScreenWidth();
+    m_screenH = GetScreenHeight();
+    m_font    = LoadFontEx(m_font_family.c_str(), m_font_size, 0, 0);
+    if (!IsFontValid(m_font)) { m_font = GetFontDefault(); }
 
-        m_camera          = { 0 };
-        m_camera.target   = { 0, 0 };
-        m_camera.offset   = { 0, 0 };
-        m_camera.rotation = 0.0f;
-        m_camera.zoom     = 1.0f;
+    m_camera          = { 0 };
+    m_camera.target   = { 0, 0 };
+    m_camera.offset   = { 0, 0 };
+    m_camera.rotation = 0.0f;
+    m_camera.zoom     = 1.0f;
+
+    initAudio();
+    initSonification();
+
+    if (!m_openFileNameRequested.empty() &&
+        !OpenImage(m_openFileNameRequested))
+    {
+        TraceLog(LOG_FATAL, "Unable to open image. Exiting!");
+        exit(0);
     }
 
-    gInstance = this;
+    GUIloop();
+}
 
-    SetAudioStreamBufferSizeDefault(4096);
+void
+Sonify::initAudio() noexcept
+{
+    if (m_low_latency) m_buffer_frames = LOW_LATENCY_FRAMES;
 
     InitAudioDevice();
     setSamplerate(m_sampleRate);
     SetMasterVolume(0.5f);
+}
 
+void
+Sonify::loadAudioStream() noexcept
+{
+    if (IsAudioStreamValid(m_stream))
+    {
+        StopAudioStream(m_stream);
+        UnloadAudioStream(m_stream);
+    }
+
+    // Two buffers of this size are queued, the output lags by about one
+    SetAudioStreamBufferSizeDefault(static_cast<int>(m_buffer_frames));
+
+    const bool f32 = m_audio_format == PlaybackFeeder::Format::F32;
+    m_stream       = LoadAudioStream(m_sampleRate, f32 ? 32 : 16, m_channels);
+    SetAudioStreamCallback(m_stream, &Sonify::audioCallback);
+    m_lastCallback = 0;
+}
+
+void
+Sonify::adaptBufferSize() noexcept
+{
+    const unsigned int underruns = m_underruns;
+    if (underruns == m_handledUnderruns) return;
+    m_handledUnderruns = underruns;
+
+    if (m_buffer_frames >= MAX_BUFFER_FRAMES) return;
+    m_buffer_frames *= 2;
+    TraceLog(LOG_INFO, "Audio underrun, stream buffer raised to %u frames",
+             m_buffer_frames);
+
+    loadAudioStream();
+    if (m_playbackState == PlaybackState::PLAYING) PlayAudioStream(m_stream);
+}
+
+void
+Sonify::startFeeder(bool crossfade) noexcept
+{
+    // offline renders have no device to feed
+    if (!IsAudioStreamValid(m_stream)) return;
+
+    if (!crossfade && m_feeder->position() > m_audioBuffer.size())
+        m_feeder->seek(0);
+    m_feeder->setLoop(m_loop);
+    m_feeder->start(m_audioBuffer, m_streaming ? m_streamer : nullptr,
+                    crossfade);
+}
+
+void
+Sonify::requestResynthesis() noexcept
+{
+    if (!m_silence)
+        TraceLog(LOG_INFO, "%s, %.0f-%.0f Hz, %.3f s per sample",
+                 m_pixelMapName.c_str(), m_min_freq, m_max_freq,
+                 m_duration_per_sample);
+
+    // nothing playing yet, the next sonification picks the values up
+    if (!m_isSonified) return;
+
+    m_resynthPending = true;
+    m_lastEdit       = GetTime();
+}
+
+void
+Sonify::updateResynthesis() noexcept
+{
+    if (m_resynth->busy()) return;
+
+    if (m_resynth->collect())
+    {
+        // Double buffered: the new audio takes over at the same point of
+        // the image, the feeder fading over from the old one
+        m_analyzer->stop();
+        m_feeder->stop();
+        m_streamer->stop(); // finished already, the feeder let go of it
+        m_audioBuffer.swap(m_backBuffer);
+        m_backBuffer.clear();
+        m_spectrumPending = true;
+        startFeeder(true);
+    }
+
+    if (!m_resynthPending || GetTime() - m_lastEdit < RESYNTH_DELAY) return;
+
+    // The producer shares the engine, let it finish the old parameters so
+    // playback never reaches unrendered columns; the crossfade swaps them
+    if (m_streamer->active() && !m_streamer->finished()) return;
+    m_resynthPending = false;
+
+    // inverting a spectrogram has no map to retune, render it again
+    if (m_spectrogram)
+    {
+        sonification();
+        return;
+    }
+
+    MapTemplate *t = currentMapTemplate();
+    if (!t) return;
+
+    static const std::vector<Pixel> noPath;
+    const std::vector<Pixel> &path = m_pi ? m_pi->pixels() : noPath;
+
+    m_backBuffer.setBackingDir(replaceHome(m_timeline_dir));
+    m_resynth->start(m_pixels, m_traversal_type, t, path, m_backBuffer);
+}
+
+void
+Sonify::initSonification() noexcept
+{
+    m_engine = new SonificationEngine(m_threads);
+    m_engine->setAngularResolution(m_angular_resolution);
+    m_engine->setMemoize(m_memoize);
+    m_engine->setSkipSilent(m_skip_silent);
+    m_engine->setChannels(m_channels);
+    m_audioBuffer.setBackingDir(replaceHome(m_timeline_dir));
+    m_streamer        = new StreamingRenderer(*m_engine);
+    m_analyzer        = new SpectrumAnalyzer();
+    m_feeder          = new PlaybackFeeder(m_channels, m_audio_format);
+    m_resynth         = new Resynthesizer(*m_engine);
     m_pixelMapManager = new PixelMapManager();
     loadDefaultPixelMappings();
     loadUserPixelMappings();
 
-    if (!m_openFileNameRequested.empty())
+    // rebuilt mappings are reloaded while playing
+    if (!m_headless)
+    {
+        m_pluginWatcher = new PluginWatcher();
+        m_pluginWatcher->start(m_mappings_dir);
+    }
+}
+
+void
+Sonify::runHeadless() noexcept
+{
+    // With an output file this is a pure offline render: no window, GL
+    // context or audio device, the image is decoded on the CPU and the
+    // program exits as soon as the file is written
+    const bool offline = !m_outputFileName.empty();
+
+    if (!offline) initAudio();
+    initSonification();
+
+    const bool video = isVideoFile(m_outputFileName);
+    bool banded      = m_band_rows > 0 && !video;
+
+    // Anything else is decoded whole, say so rather than use the memory
+    // quietly
+    if (banded && !BandReader::supported(replaceHome(m_openFileNameRequested)))
     {
-        if (OpenImage(m_openFileNameRequested))
+        TraceLog(LOG_WARNING,
+                 "--band-rows needs a binary PNM/PAM image (.pgm, .ppm, "
+                 ".pam), loading all of %s instead",
+                 m_openFileNameRequested.c_str());
+        banded = false;
+    }
+    else if (m_band_rows > 0 && video)
+        TraceLog(LOG_WARNING, "--band-rows is ignored for video output");
+
+    if (banded)
+    {
+        // Never holds the whole image, nor the whole audio
+        if (!sonifyOutOfCore())
         {
-            if (m_headless)
-            {
-                if (!m_silence)
-                    TraceLog(LOG_INFO, "Sonifying...Please wait...");
-                sonification();
-                if (!m_silence)
-                {
-                    TraceLog(LOG_INFO, "Duration: %f(s)",
-                             m_audioBuffer.size() / m_sampleRate);
-                }
-                toggleAudioPlayback();
-            }
+            TraceLog(LOG_FATAL, "Unable to sonify image. Exiting!");
+            exit(0);
         }
-        else
+        if (offline) return;
+    }
+
+    if (!OpenImage(m_openFileNameRequested))
+    {
+        TraceLog(LOG_FATAL, "Unable to open image. Exiting!");
+        exit(0);
+    }
+
+    // Audio goes to the file as it is rendered, spectrogram inversion needs
+    // the neighbouring frames and renders everything at once
+    if (offline && !video && !m_spectrogram)
+    {
+        if (!sonifyToFile())
         {
-            TraceLog(LOG_FATAL, "Unable to open image. Exiting!");
+            TraceLog(LOG_FATAL, "Unable to sonify image. Exiting!");
             exit(0);
         }
+        return;
     }
 
-    GUIloop();
+    // nothing is played while rendering offline, render everything at once
+    if (offline) m_streaming = false;
+
+    if (!m_silence) TraceLog(LOG_INFO, "Sonifying...Please wait...");
+    sonification();
+    if (!m_silence)
+    {
+        TraceLog(LOG_INFO, "Duration: %f(s)",
+                 m_audioBuffer.size() / (m_sampleRate * m_channels));
+    }
+
+    if (video && !renderVideoOffline())
+    {
+        TraceLog(LOG_FATAL, "Unable to render the video. Exiting!");
+        exit(0);
+    }
+
+    if (offline) return;
+
+    // Play the result, the audio thread requests the exit once it is done
+    toggleAudioPlayback();
+    while (!m_exit_requested)
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
 }
 
 void
@@ -96,11 +349,10 @@ Sonify::GUIloop() noexcept
 {
     while (!WindowShouldClose() && !m_exit_requested)
     {
-        if (m_headless) continue;
-
         m_timer.update();
+        if (m_low_latency) adaptBufferSize();
 
-        if (m_cursorUpdater) m_cursorUpdater(m_audioReadPos);
+        if (m_cursorUpdater) m_cursorUpdater(m_feeder->position());
         // Track window resize
         const int newW = GetScreenWidth();
         const int newH = GetScreenHeight();
@@ -110,8 +362,10 @@ Sonify::GUIloop() noexcept
             m_screenH = newH;
         }
 
-        // Only handle input if not recording
-        if (m_recordingState != RecordingState::RECORDING)
+        // Only handle input if not recording. The frame that finishes a
+        // recording leaves the timeline alone too, its audio is still being
+        // written out.
+        if (m_recordingState == RecordingState::NONE)
         {
             if (m_traversal_type == TraversalType::PATH) handleMouseEvents();
 
@@ -119,7 +373,10 @@ Sonify::GUIloop() noexcept
             handleKeyEvents();
 
             if (m_playbackState == PlaybackState::PLAYING && m_cursorUpdater)
-                m_cursorUpdater(m_audioReadPos);
+                m_cursorUpdater(m_feeder->position());
+
+            updatePlugins();
+            updateResynthesis();
         }
 
         // --- Render ---
@@ -131,9 +388,13 @@ Sonify::GUIloop() noexcept
         {
             case RecordingState::RECORDING:
             {
-                // Render to texture
+                // Render to the next texture of the ring, then read back the
+                // one rendered RECORD_RING - 1 frames ago: the GPU is done
+                // with it by now, so the readback does not stall the frame
+                RenderTexture2D &target =
+                    m_recordTargets[m_recordFrame % RECORD_RING];
 
-                BeginTextureMode(m_recordTarget);
+                BeginTextureMode(target);
 
                 BeginMode2D(m_camera);
                 {
@@ -143,14 +404,9 @@ Sonify::GUIloop() noexcept
                 EndMode2D();
                 EndTextureMode();
 
-                // Dump to ffmpeg
-                Image frame = LoadImageFromTexture(m_recordTarget.texture);
-                ImageFlipVertical(&frame);
-                std::fwrite(frame.data, 1,
-                            (size_t)frame.width * (size_t)frame.height *
-                                sizeof(uint32_t),
-                            m_ffmpeg);
-                UnloadImage(frame);
+                ++m_recordFrame;
+                if (m_recordFrame >= RECORD_RING)
+                    readbackFrame(m_recordTargets[m_recordFrame % RECORD_RING]);
 
                 DrawText("Recording...", 10, 10, 30, RED);
                 break;
@@ -158,11 +414,16 @@ Sonify::GUIloop() noexcept
 
             case RecordingState::FINISHED:
             {
-                if (m_ffmpeg)
+                if (m_ffmpeg.video)
                 {
-                    fflush(m_ffmpeg);
-                    pclose(m_ffmpeg);
-                    m_ffmpeg = nullptr;
+                    // frames still in the ring, oldest first
+                    const size_t pending =
+                        std::min<size_t>(m_recordFrame, RECORD_RING - 1);
+                    for (size_t i = m_recordFrame - pending; i < m_recordFrame;
+                         ++i)
+                        readbackFrame(m_recordTargets[i % RECORD_RING]);
+
+                    finishRecording();
                 }
                 m_recordingState = RecordingState::NONE;
 
@@ -212,7 +473,13 @@ Sonify::~Sonify() noexcept
         StopAudioStream(m_stream);
         UnloadAudioStream(m_stream);
     }
-    CloseAudioDevice();
+    if (IsAudioDeviceReady()) CloseAudioDevice();
+    if (m_pluginWatcher) delete m_pluginWatcher;
+    if (m_feeder) delete m_feeder;
+    if (m_analyzer) delete m_analyzer;
+    if (m_resynth) delete m_resynth;
+    if (m_streamer) delete m_streamer;
+    if (m_engine) delete m_engine;
     if (m_pixelMapManager) delete m_pixelMapManager;
     if (m_texture) delete m_texture;
     if (m_li) delete m_li;
@@ -220,8 +487,10 @@ Sonify::~Sonify() noexcept
     if (m_pi) delete m_pi;
 
     if (IsFontValid(m_font)) UnloadFont(m_font);
-    if (IsRenderTextureValid(m_recordTarget))
-        UnloadRenderTexture(m_recordTarget);
+    if (m_ffmpeg.video) finishRecording(); // closed mid-recording
+    if (m_frameWriter) delete m_frameWriter;
+    for (auto &target : m_recordTargets)
+        if (IsRenderTextureValid(target)) UnloadRenderTexture(target);
 }
 
 void
@@ -229,40 +498,62 @@ Sonify::audioCallback(void *buffer, unsigned int frames)
 {
     if (!gInstance) return;
 
-    int16_t *out = reinterpret_cast<int16_t *>(buffer);
-    auto &audio  = gInstance->m_audioBuffer;
-    auto &pos    = gInstance->m_audioReadPos;
+    // interleaved, `frames` frames of m_channels samples
+    const unsigned int samples = frames * gInstance->m_channels;
+    const bool f32 = gInstance->m_audio_format == PlaybackFeeder::Format::F32;
 
-    for (unsigned int i = 0; i < frames; ++i)
+    if (!gInstance->m_feeder)
     {
-        if (pos >= audio.size())
-        {
-            out[i] = 0;
-
-            if (gInstance->m_loop)
-            {
-                pos                        = 0;
-                gInstance->m_playbackState = PlaybackState::PLAYING;
-            }
-            else
-            {
-                gInstance->m_playbackState = PlaybackState::FINISHED;
-                if (gInstance->m_headless) gInstance->m_exit_requested = true;
-
-                // recording stops automatically once audio finishes
-                if (gInstance->m_recordingState == RecordingState::RECORDING)
-                    gInstance->m_recordingState = RecordingState::FINISHED;
-            }
-        }
-        else { out[i] = audio[pos++]; }
+        std::memset(buffer, 0, samples * (f32 ? sizeof(float) : sizeof(short)));
+        return;
     }
+
+    // A callback coming much later than the previous one has played out
+    // means the device ran dry in between
+    const int64_t now    = steadyNs();
+    const int64_t period = static_cast<int64_t>(frames * 1e9 /
+                                                gInstance->m_sampleRate);
+    const int64_t last = gInstance->m_lastCallback.exchange(now);
+    if (last && now - last > 2 * period) ++gInstance->m_underruns;
+
+    // what is written now is heard once the other buffer has played
+    const int64_t request = gInstance->m_requestTime.exchange(0);
+    if (request) gInstance->m_latency = (now - request + period) * 1e-6f;
+
+    // Only block copies out of the ring, the timeline is never touched here
+    const bool ended =
+        f32 ? gInstance->m_feeder->pull(
+                  std::span<float>(static_cast<float *>(buffer), samples))
+            : gInstance->m_feeder->pull(
+                  std::span<short>(static_cast<short *>(buffer), samples));
+    if (!ended) return;
+
+    gInstance->m_playbackState = PlaybackState::FINISHED;
+    if (gInstance->m_headless) gInstance->m_exit_requested = true;
+
+    // recording stops automatically once audio finishes
+    if (gInstance->m_recordingState == RecordingState::RECORDING)
+        gInstance->m_recordingState = RecordingState::FINISHED;
 }
 
 bool
 Sonify::OpenImage(std::string fileName) noexcept
 {
-    m_texture = new DTexture();
+    if (m_resynth) m_resynth->wait();
+    m_resynthPending = false;
+    if (m_feeder) m_feeder->stop(); // before the streamer it polls
+    if (m_streamer) m_streamer->stop();
+    m_pixels.clear();
     if (IsImageValid(m_image)) UnloadImage(m_image);
+
+    // No GL context in headless mode, decode on the CPU only
+    if (m_headless)
+    {
+        m_image = LoadImage(replaceHome(fileName).c_str());
+        return IsImageValid(m_image);
+    }
+
+    m_texture = new DTexture();
     if (IsTextureValid(m_texture->texture()))
         UnloadTexture(m_texture->texture());
     if (!fileName.empty()) fileName = replaceHome(fileName);
@@ -328,15 +619,61 @@ Sonify::handleKeyEvents() noexcept
     if (IsKeyPressed(KEY_L)) toggleLooping();
     if (IsKeyPressed(KEY_F1)) reloadCurrentPixelMappingSharedObject();
 
+    // Live tuning, resynthesized in the background while playing
+    bool tuned = false;
+    auto tune  = [&tuned](float &value, float next, float lo, float hi)
+    {
+        value = std::clamp(next, lo, std::max(lo, hi));
+        tuned = true;
+    };
+    const float nyquist = m_sampleRate / 2;
+
+    if (IsKeyPressed(KEY_LEFT_BRACKET))
+        tune(m_min_freq, m_min_freq - 50, 0, m_max_freq - 50);
+    if (IsKeyPressed(KEY_RIGHT_BRACKET))
+        tune(m_min_freq, m_min_freq + 50, 0, m_max_freq - 50);
+    if (IsKeyPressed(KEY_SEMICOLON))
+        tune(m_max_freq, m_max_freq - 500, m_min_freq + 50, nyquist);
+    if (IsKeyPressed(KEY_APOSTROPHE))
+        tune(m_max_freq, m_max_freq + 500, m_min_freq + 50, nyquist);
+    if (IsKeyPressed(KEY_N))
+        tune(m_duration_per_sample, m_duration_per_sample / 1.25f, 0.001f, 2);
+    if (IsKeyPressed(KEY_M))
+        tune(m_duration_per_sample, m_duration_per_sample * 1.25f, 0.001f, 2);
+    if (IsKeyPressed(KEY_P))
+    {
+        // next pixel map, in the order they were loaded
+        const auto names = m_pixelMapManager->mappingNames();
+        auto it = std::find(names.begin(), names.end(), m_pixelMapName);
+        if (!names.empty())
+        {
+            m_pixelMapName = (it == names.end() || ++it == names.end())
+                                 ? names.front()
+                                 : *it;
+            tuned          = true;
+        }
+    }
+
+    if (tuned) requestResynthesis();
+
     if (IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT))
     {
-        // Seek till end/beginning
-        if (IsKeyPressed(KEY_PERIOD))
+        // Seek till end/beginning, the last whole frame when there is one
+        const uint64_t size = m_audioBuffer.size();
+        if (IsKeyPressed(KEY_PERIOD) && size >= m_channels)
         {
-            m_audioReadPos = (unsigned int)m_audioBuffer.size() - 1;
+            const uint64_t end = size - size % m_channels - m_channels;
+            m_requestTime      = steadyNs();
+            m_feeder->seek(end);
+            m_streamer->seek(end);
             if (!m_loop) m_playbackState = PlaybackState::FINISHED;
         }
-        if (IsKeyPressed(KEY_COMMA)) m_audioReadPos = 0;
+        if (IsKeyPressed(KEY_COMMA))
+        {
+            m_requestTime = steadyNs();
+            m_feeder->seek(0);
+            m_streamer->seek(0);
+        }
     }
 
     if (IsKeyPressed(KEY_COMMA)) seekCursor(-1);
@@ -353,7 +690,9 @@ Sonify::pauseAudioStream() noexcept
 void
 Sonify::playAudioStream() noexcept
 {
-    if (m_audioReadPos >= m_audioBuffer.size()) m_audioReadPos = 0;
+    if (m_feeder->position() >= m_audioBuffer.size()) m_feeder->seek(0);
+    m_lastCallback = 0;
+    m_requestTime  = steadyNs();
     PlayAudioStream(m_stream);
 
     m_playbackState = PlaybackState::PLAYING;
@@ -364,7 +703,7 @@ Sonify::resetAudioStream() noexcept
 {
     PauseAudioStream(m_stream);
     m_playbackState = PlaybackState::STOPPED;
-    m_audioReadPos  = 0;
+    m_feeder->seek(0);
 }
 
 void
@@ -388,387 +727,317 @@ Sonify::sonification() noexcept
 {
     if (!IsImageValid(m_image)) return;
 
-    Color *pixels = LoadImageColors(m_image);
-    const int h   = m_image.height;
-    const int w   = m_image.width;
-
-    if (!pixels)
+    if (m_pixels.empty() && !m_pixels.load(m_image))
     {
         TraceLog(LOG_WARNING, "No pixels data found!");
         return;
     }
 
-    AudioBuffer soundBuffer;
+    // the producers must let go of the map and the timeline first, the
+    // device keeps playing what is already queued
+    m_resynth->wait();
+    m_resynthPending = false;
+    m_feeder->stop();
+    m_streamer->stop();
+    m_analyzer->stop();
+    m_spectrumPending = true;
 
-    if (!m_headless) updateCursorUpdater();
+    // columns are the frames of the spectrogram, played left to right
+    if (m_spectrogram) m_traversal_type = TraversalType::LEFT_TO_RIGHT;
 
-    MapTemplate *t = m_pixelMapManager->getMapTemplate(m_pixelMapName);
+    if (!m_headless) updateCursorUpdater();
 
-    if (!t)
+    if (m_spectrogram)
     {
-        TraceLog(LOG_ERROR, "Unable to find MapTemplate!");
+        if (!sonifySpectrogram()) return;
+        m_isSonified = true;
+        startFeeder();
+
+        if (!m_outputFileName.empty() && !m_audioExported &&
+            !isVideoFile(m_outputFileName))
+        {
+            saveAudio(m_outputFileName);
+            m_audioExported = true;
+        }
         return;
     }
 
-    t->setMinFreq(m_min_freq);
-    t->setMaxFreq(m_max_freq);
-    t->setFreqMap(m_freq_map_func);
-    t->setDurationPerSample(m_duration_per_sample);
-
-    m_mapFunc = [&t](const std::vector<Pixel> &pixels) -> std::vector<short>
-    { return t->mapping(pixels); };
+    MapTemplate *t = currentMapTemplate();
+    if (!t) return;
 
-    if (!m_mapFunc)
+    if (m_traversal_type == TraversalType::PATH && m_headless)
     {
-        TraceLog(LOG_FATAL, "Unable to find valid pixel mapping function");
-        return;
+        TraceLog(LOG_FATAL, "Cannot run Traversal type of PATH in "
+                            "headless mode. Exitting!");
+        exit(0);
     }
 
-    switch (m_traversal_type)
-    {
-        case TraversalType::LEFT_TO_RIGHT:
-            collectLeftToRight(pixels, w, h, soundBuffer);
-            break;
-
-        case TraversalType::RIGHT_TO_LEFT:
-            collectRightToLeft(pixels, w, h, soundBuffer);
-            break;
-
-        case TraversalType::TOP_TO_BOTTOM:
-            collectTopToBottom(pixels, w, h, soundBuffer);
-            break;
-
-        case TraversalType::BOTTOM_TO_TOP:
-            collectBottomToTop(pixels, w, h, soundBuffer);
-            break;
+    static const std::vector<Pixel> noPath;
+    const std::vector<Pixel> &path = m_pi ? m_pi->pixels() : noPath;
 
-        case TraversalType::CIRCLE_INWARDS:
-            collectCircleInwards(pixels, w, h, soundBuffer);
-            break;
-
-        case TraversalType::CIRCLE_OUTWARDS:
-            collectCircleOutwards(pixels, w, h, soundBuffer);
-            break;
-
-        case TraversalType::CLOCKWISE:
-            collectClockwise(pixels, w, h, soundBuffer);
-            break;
-
-        case TraversalType::ANTICLOCKWISE:
-            collectAntiClockwise(pixels, w, h, soundBuffer);
-            break;
+    if (m_streaming)
+    {
+        // Columns get rendered in the background starting from the current
+        // position, playback can start right away
+        SonificationEngine::Plan plan;
+        m_engine->plan(m_pixels, m_traversal_type, t, path, plan);
+        if (!m_streamer->start(std::move(plan), m_audioBuffer)) return;
+        m_streamer->seek(m_feeder->position());
+    }
+    else
+    {
+        // every column is mapped straight into its slot of the timeline
+        m_engine->render(m_pixels, m_traversal_type, t, path, m_audioBuffer);
 
-        case TraversalType::PATH:
+        if (m_memoize || m_skip_silent)
         {
-            if (m_headless)
-            {
-                TraceLog(LOG_FATAL, "Cannot run Traversal type of PATH in "
-                                    "headless mode. Exitting!");
-                exit(0);
-            }
-
-            const auto &pathPixels = m_pi->pixels();
-            for (const auto &p : pathPixels)
-            {
-                std::vector<Pixel> pixelGroup(
-                    10,
-                    p); // Repeat pixel 10 times for more audio
-                soundBuffer.push_back(m_mapFunc(pixelGroup));
-            }
+            const auto stats = m_engine->memoStats();
+            TraceLog(LOG_INFO, "Columns: %zu mapped, %zu reused, %zu silent",
+                     stats.misses, stats.hits, stats.silent);
         }
-        break;
-
-        case TraversalType::REGION:
-            collectRegion(pixels, w, h, soundBuffer);
-            break;
     }
 
-    m_audioBuffer.clear();
-
-    for (auto &col : soundBuffer)
-        m_audioBuffer.insert(m_audioBuffer.end(), col.begin(), col.end());
-
     // if (m_cursorUpdater) m_cursorUpdater(0);
-    UnloadImageColors(pixels);
     m_isSonified = true;
+    startFeeder();
 
-    if (!m_outputFileName.empty() && !m_audioExported)
+    if (!m_outputFileName.empty() && !m_audioExported &&
+        !isVideoFile(m_outputFileName))
     {
         saveAudio(m_outputFileName);
         m_audioExported = true;
     }
 }
 
-void
-Sonify::collectLeftToRight(Color *pixels, int w, int h,
-                           AudioBuffer &buffer) noexcept
+bool
+Sonify::sonifySpectrogram() noexcept
 {
-    std::vector<Pixel> pixelCol;
-    pixelCol.reserve((size_t)h);
-
-    for (int x = 0; x < w; x++)
+    SpectrogramRenderer::Options options;
+    options.sampleRate = m_sampleRate;
+    options.hop        = std::max<size_t>(
+        1, static_cast<size_t>(m_duration_per_sample * m_sampleRate));
+    options.minFreq    = m_min_freq;
+    options.maxFreq    = m_max_freq;
+    options.scale      = m_spectrogram_scale;
+    options.iterations = m_griffin_lim;
+
+    SpectrogramRenderer renderer(m_engine->pool(), options);
+    std::vector<short> audio;
+    if (!renderer.render(m_pixels, audio))
     {
-        pixelCol.clear();
-        for (int y = 0; y < h; y++)
-        {
-            const auto &px = pixels[y * w + x];
-            pixelCol.push_back({ RGBA{ px.r, px.g, px.b, px.a }, x, y });
-        }
-        buffer.push_back(m_mapFunc(pixelCol));
+        TraceLog(LOG_ERROR, "Unable to invert the spectrogram");
+        return false;
     }
-}
 
-void
-Sonify::collectRightToLeft(Color *pixels, int w, int h,
-                           AudioBuffer &buffer) noexcept
-{
-    std::vector<Pixel> pixelCol;
-    pixelCol.reserve(h);
+    TraceLog(LOG_INFO, "Spectrogram: %zu point FFT, %d Griffin-Lim iterations",
+             renderer.fftSize(), m_griffin_lim);
+
+    // the same signal on every channel
+    const uint64_t C = m_channels;
+    if (!m_audioBuffer.allocate(audio.size() * C)) return false;
 
-    for (int x = w - 1; x >= 0; x--)
+    uint64_t pos = 0;
+    for (size_t i = 0; i < m_audioBuffer.chunks(); ++i)
     {
-        pixelCol.clear();
-        for (int y = 0; y < h; y++)
-        {
-            const auto &px = pixels[y * w + x];
-            pixelCol.push_back({ RGBA{ px.r, px.g, px.b, px.a }, x, y });
-        }
-        buffer.push_back(m_mapFunc(pixelCol));
+        const size_t n = m_audioBuffer.chunk(i).size();
+        auto out       = m_audioBuffer.range(pos, pos + n);
+        for (size_t k = 0; k < n; ++k)
+            out[k] = audio[(pos + k) / C];
+        pos += n;
     }
+
+    return true;
 }
 
-void
-Sonify::collectTopToBottom(Color *pixels, int w, int h,
-                           AudioBuffer &buffer) noexcept
+MapTemplate *
+Sonify::currentMapTemplate() noexcept
 {
-    std::vector<Pixel> pixelCol;
-    pixelCol.reserve(h);
+    MapTemplate *t = m_pixelMapManager->getMapTemplate(m_pixelMapName);
 
-    for (int y = 0; y < h; y++)
+    if (!t)
     {
-        pixelCol.clear();
-        for (int x = 0; x < w; x++)
-        {
-            const auto &px = pixels[y * w + x];
-            pixelCol.push_back({ RGBA{ px.r, px.g, px.b, px.a }, x, y });
-        }
-        buffer.push_back(m_mapFunc(pixelCol));
+        TraceLog(LOG_ERROR, "Unable to find MapTemplate!");
+        return nullptr;
     }
+
+    t->setMinFreq(m_min_freq);
+    t->setMaxFreq(m_max_freq);
+    t->setFreqMap(m_freq_map_func);
+    t->setDurationPerSample(m_duration_per_sample);
+
+    return t;
 }
 
-void
-Sonify::collectBottomToTop(Color *pixels, int w, int h,
-                           AudioBuffer &buffer) noexcept
+bool
+Sonify::sonifyOutOfCore() noexcept
 {
-    std::vector<Pixel> pixelCol;
-    pixelCol.reserve(h);
+    if (m_traversal_type != TraversalType::TOP_TO_BOTTOM &&
+        m_traversal_type != TraversalType::BOTTOM_TO_TOP)
+    {
+        TraceLog(LOG_ERROR, "Out-of-core mode only supports the top to bottom "
+                            "and bottom to top traversals");
+        return false;
+    }
 
-    for (int y = h - 1; y >= 0; y--)
+    if (m_outputFileName.empty())
     {
-        pixelCol.clear();
-        for (int x = 0; x < w; x++)
-        {
-            const auto &px = pixels[y * w + x];
-            pixelCol.push_back({ RGBA{ px.r, px.g, px.b, px.a }, x, y });
-        }
-        buffer.push_back(m_mapFunc(pixelCol));
+        TraceLog(LOG_ERROR, "Out-of-core mode needs an output file");
+        return false;
     }
-}
 
-void
-Sonify::collectCircleOutwards(Color *pixels, int w, int h,
-                              AudioBuffer &buffer) noexcept
-{
-    int cx = w / 2;
-    int cy = h / 2;
+    BandReader reader;
+    if (!reader.open(replaceHome(m_openFileNameRequested))) return false;
 
-    int maxRadius = std::max(cx, w - cx - 1);
-    maxRadius     = std::max(maxRadius, std::max(cy, h - cy - 1));
+    MapTemplate *t = currentMapTemplate();
+    if (!t) return false;
 
-    std::vector<Pixel> pixelCol;
+    WavWriter wav;
+    if (!wav.open(replaceHome(m_outputFileName),
+                  static_cast<unsigned int>(m_sampleRate), m_channels,
+                  m_sample_format))
+        return false;
 
-    for (int r = 0; r <= maxRadius; ++r)
+    if (!m_silence)
     {
-        pixelCol.clear();
-
-        // Loop over bounding box of the current radius
-        int left   = std::max(0, cx - r);
-        int right  = std::min(w - 1, cx + r);
-        int top    = std::max(0, cy - r);
-        int bottom = std::min(h - 1, cy + r);
-
-        // Top row: left → right
-        for (int x = left; x <= right; ++x)
-        {
-            const auto &px = pixels[top * w + x];
-            pixelCol.push_back({ RGBA{ px.r, px.g, px.b, px.a }, x, top });
-        }
+        TraceLog(LOG_INFO, "Sonifying %dx%d image in bands of %d rows...",
+                 reader.width(), reader.height(), m_band_rows);
+    }
 
-        // Right column: top+1 → bottom
-        for (int y = top + 1; y <= bottom; ++y)
-        {
-            const auto &px = pixels[y * w + right];
-            pixelCol.push_back({ RGBA{ px.r, px.g, px.b, px.a }, right, y });
-        }
+    bool ok = m_engine->renderBands(reader, m_traversal_type, t, m_band_rows,
+                                    [&wav](std::span<const short> samples)
+    { return wav.write(samples); });
 
-        // Bottom row: right-1 → left (if top != bottom)
-        if (top != bottom)
-        {
-            for (int x = right - 1; x >= left; --x)
-            {
-                const auto &px = pixels[bottom * w + x];
-                pixelCol.push_back(
-                    { RGBA{ px.r, px.g, px.b, px.a }, x, bottom });
-            }
-        }
-
-        // Left column: bottom-1 → top+1 (if left != right)
-        if (left != right)
-        {
-            for (int y = bottom - 1; y > top; --y)
-            {
-                const auto &px = pixels[y * w + left];
-                pixelCol.push_back({ RGBA{ px.r, px.g, px.b, px.a }, left, y });
-            }
-        }
+    ok = wav.close() && ok;
 
-        if (!pixelCol.empty()) buffer.push_back(m_mapFunc(pixelCol));
+    if (!ok) TraceLog(LOG_ERROR, "Out-of-core sonification failed");
+    else if (!m_silence)
+    {
+        TraceLog(LOG_INFO, "Duration: %f(s)",
+                 static_cast<double>(wav.frames()) / m_sampleRate);
     }
+
+    return ok;
 }
 
-void
-Sonify::collectCircleInwards(Color *pixels, int w, int h,
-                             AudioBuffer &buffer) noexcept
+bool
+Sonify::sonifyToFile() noexcept
 {
-    int left   = 0;
-    int right  = w - 1;
-    int top    = 0;
-    int bottom = h - 1;
-
-    std::vector<Pixel> pixelCol;
-
-    while (left <= right && top <= bottom)
+    if (m_traversal_type == TraversalType::PATH ||
+        m_traversal_type == TraversalType::REGION)
     {
-        pixelCol.clear();
-
-        // Top row: left → right
-        for (int x = left; x <= right; ++x)
-        {
-            const auto &px = pixels[top * w + x];
-            pixelCol.push_back({ RGBA{ px.r, px.g, px.b, px.a }, x, top });
-        }
+        TraceLog(LOG_ERROR, "Cannot run this traversal type in headless mode");
+        return false;
+    }
 
-        // Right column: top+1 → bottom
-        for (int y = top + 1; y <= bottom; ++y)
-        {
-            const auto &px = pixels[y * w + right];
-            pixelCol.push_back({ RGBA{ px.r, px.g, px.b, px.a }, right, y });
-        }
+    if (m_pixels.empty() && !m_pixels.load(m_image))
+    {
+        TraceLog(LOG_WARNING, "No pixels data found!");
+        return false;
+    }
 
-        // Bottom row: right-1 → left (if top != bottom)
-        if (top != bottom)
-        {
-            for (int x = right - 1; x >= left; --x)
-            {
-                const auto &px = pixels[bottom * w + x];
-                pixelCol.push_back(
-                    { RGBA{ px.r, px.g, px.b, px.a }, x, bottom });
-            }
-        }
+    MapTemplate *t = currentMapTemplate();
+    if (!t) return false;
 
-        // Left column: bottom-1 → top+1 (if left != right)
-        if (left != right)
-        {
-            for (int y = bottom - 1; y > top; --y)
-            {
-                const auto &px = pixels[y * w + left];
-                pixelCol.push_back({ RGBA{ px.r, px.g, px.b, px.a }, left, y });
-            }
-        }
+    static const std::vector<Pixel> noPath;
+    SonificationEngine::Plan plan;
+    if (!m_engine->plan(m_pixels, m_traversal_type, t, noPath, plan))
+        return false;
 
-        buffer.push_back(m_mapFunc(pixelCol));
+    WavWriter wav;
+    if (!wav.open(replaceHome(m_outputFileName),
+                  static_cast<unsigned int>(m_sampleRate), m_channels,
+                  m_sample_format))
+        return false;
 
-        // Move to inner circle
-        left++;
-        right--;
-        top++;
-        bottom--;
-    }
-}
+    if (!m_silence) TraceLog(LOG_INFO, "Sonifying...Please wait...");
 
-void
-Sonify::collectRegion(Color *pixels, int w, int h, AudioBuffer &buffer) noexcept
-{
-}
+    // about 2 MiB of samples per block
+    constexpr size_t BLOCK_SAMPLES = 1 << 20;
+    bool ok = m_engine->renderStream(plan, BLOCK_SAMPLES,
+                                     [&wav](std::span<const short> samples)
+    { return wav.write(samples); });
 
-void
-Sonify::collectAntiClockwise(Color *pixels, int w, int h,
-                             AudioBuffer &buffer) noexcept
-{
-    int cx     = w / 2;
-    int cy     = h / 2;
-    int length = static_cast<int>(std::sqrt(cx * cx + cy * cy));
+    ok = wav.close() && ok;
 
-    for (int angle = 0; angle < 360; angle++)
+    if (!ok) TraceLog(LOG_ERROR, "Unable to write the audio");
+    else if (!m_silence)
     {
-        float rad  = -angle * (M_PI / 180.0f);
-        float cosA = std::cos(rad);
-        float sinA = std::sin(rad);
-
-        std::vector<Pixel> pixelCol;
-        pixelCol.reserve(length);
-
-        for (int r = 0; r < length; r++)
+        if (m_memoize || m_skip_silent)
         {
-            int x = cx + static_cast<int>(r * cosA);
-            int y = cy + static_cast<int>(r * sinA);
-
-            if (x >= 0 && x < w && y >= 0 && y < h)
-            {
-                const auto &p = pixels[y * w + x];
-                pixelCol.emplace_back(
-                    Pixel{ RGBA{ p.r, p.g, p.b, p.a }, x, y });
-            }
-            else { break; }
+            const auto stats = m_engine->memoStats();
+            TraceLog(LOG_INFO, "Columns: %zu mapped, %zu reused, %zu silent",
+                     stats.misses, stats.hits, stats.silent);
         }
-
-        buffer.push_back(m_mapFunc(pixelCol));
+        TraceLog(LOG_INFO, "Duration: %f(s)",
+                 static_cast<double>(wav.frames()) / m_sampleRate);
     }
+
+    return ok;
 }
 
-void
-Sonify::collectClockwise(Color *pixels, int w, int h,
-                         AudioBuffer &buffer) noexcept
+bool
+Sonify::runBatch() noexcept
 {
-    int cx     = w / 2;
-    int cy     = h / 2;
-    int length = static_cast<int>(std::sqrt(cx * cx + cy * cy));
-
-    for (int angle = 0; angle < 360; angle++)
+    if (m_traversal_type == TraversalType::PATH ||
+        m_traversal_type == TraversalType::REGION)
     {
-        float rad  = angle * (M_PI / 180.0f);
-        float cosA = std::cos(rad);
-        float sinA = std::sin(rad);
+        TraceLog(LOG_ERROR, "Batch mode needs a traversal that does not "
+                            "depend on user input");
+        return false;
+    }
 
-        std::vector<Pixel> pixelCol;
-        pixelCol.reserve(length);
+    const auto inputs =
+        BatchRunner::collectInputs(replaceHome(m_batchInput));
+    if (inputs.empty())
+    {
+        TraceLog(LOG_ERROR, "No images found in %s", m_batchInput.c_str());
+        return false;
+    }
 
-        for (int r = 0; r < length; r++)
+    MapTemplate *t = currentMapTemplate();
+    if (!t) return false;
+
+    BatchRunner::Options options;
+    options.traversal  = m_traversal_type;
+    options.jobs       = m_jobs;
+    options.threads    = m_threads;
+    options.angles     = m_angular_resolution;
+    options.memoize    = m_memoize;
+    options.skipSilent = m_skip_silent;
+    options.sampleRate = m_sampleRate;
+    options.channels   = m_channels;
+    options.format     = m_sample_format;
+    if (!m_batchOutput.empty()) options.output = replaceHome(m_batchOutput);
+
+    const auto start   = std::chrono::steady_clock::now();
+    const auto results = BatchRunner(options).run(inputs, t);
+    const std::chrono::duration<double> wall =
+        std::chrono::steady_clock::now() - start;
+
+    size_t failed = 0;
+    for (const auto &r : results)
+        if (!r.ok) ++failed;
+
+    if (!m_silence)
+    {
+        LOG("{:<40} {:>10} {:>10} {:>10} {:>10}", "Image", "Decode ms",
+            "Render ms", "Write ms", "Audio s");
+        for (const auto &r : results)
         {
-            int x = cx + static_cast<int>(r * cosA);
-            int y = cy + static_cast<int>(r * sinA);
-
-            if (x >= 0 && x < w && y >= 0 && y < h)
+            const std::string name =
+                std::filesystem::path(r.input).filename().string();
+            if (!r.ok) { LOG("{:<40} {:>43}", name, "FAILED"); }
+            else
             {
-                const auto &p = pixels[y * w + x];
-                pixelCol.emplace_back(
-                    Pixel{ RGBA{ p.r, p.g, p.b, p.a }, x, y });
+                LOG("{:<40} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.2f}", name,
+                    r.decodeMs, r.renderMs, r.writeMs, r.seconds);
             }
-            else { break; }
         }
-
-        buffer.push_back(m_mapFunc(pixelCol));
+        LOG("{} images, {} failed, {:.2f} s", results.size(), failed,
+            wall.count());
     }
+
+    return failed == 0;
 }
 
 void
@@ -786,10 +1055,10 @@ Sonify::updateCursorUpdater() noexcept
             m_li->setHeight(imgh);
             m_li->setPolarMode(false);
             m_li->setWidth(m_cursor_thickness);
-            m_cursorUpdater = [this, imgw, imgpos](int audioPos)
+            m_cursorUpdater = [this, imgw, imgpos](uint64_t audioPos)
             {
-                float progress =
-                    (float)audioPos / static_cast<float>(m_audioBuffer.size());
+                float progress = static_cast<float>(
+                    audioPos / static_cast<double>(m_audioBuffer.size()));
                 m_li->setPos({ ceilf(progress * imgw + imgpos.x), imgpos.y });
             };
         }
@@ -801,10 +1070,10 @@ Sonify::updateCursorUpdater() noexcept
             m_li->setHeight(imgh);
             m_li->setPolarMode(false);
             m_li->setWidth(m_cursor_thickness);
-            m_cursorUpdater = [this, imgpos, imgw](int audioPos)
+            m_cursorUpdater = [this, imgpos, imgw](uint64_t audioPos)
             {
-                const float progress =
-                    (float)audioPos / static_cast<float>(m_audioBuffer.size());
+                const float progress = static_cast<float>(
+                    audioPos / static_cast<double>(m_audioBuffer.size()));
                 m_li->setPos({ imgpos.x + imgw - progress * imgw, imgpos.y });
             };
         }
@@ -816,10 +1085,10 @@ Sonify::updateCursorUpdater() noexcept
             m_li->setPolarMode(false);
             m_li->setWidth(imgw);
             m_li->setHeight(m_cursor_thickness);
-            m_cursorUpdater = [this, imgpos, imgh](int audioPos)
+            m_cursorUpdater = [this, imgpos, imgh](uint64_t audioPos)
             {
-                const float progress =
-                    (float)audioPos / static_cast<float>(m_audioBuffer.size());
+                const float progress = static_cast<float>(
+                    audioPos / static_cast<double>(m_audioBuffer.size()));
                 m_li->setPos({ imgpos.x, imgpos.y + progress * imgh });
             };
         }
@@ -831,10 +1100,10 @@ Sonify::updateCursorUpdater() noexcept
             m_li->setPolarMode(false);
             m_li->setWidth(imgw);
             m_li->setHeight(m_cursor_thickness);
-            m_cursorUpdater = [this, imgh, imgpos](int audioPos)
+            m_cursorUpdater = [this, imgh, imgpos](uint64_t audioPos)
             {
-                const float progress =
-                    (float)audioPos / static_cast<float>(m_audioBuffer.size());
+                const float progress = static_cast<float>(
+                    audioPos / static_cast<double>(m_audioBuffer.size()));
                 m_li->setPos({ imgpos.x, imgpos.y + imgh - progress * imgh });
             };
         }
@@ -848,10 +1117,10 @@ Sonify::updateCursorUpdater() noexcept
 
             m_ci->setCenter({ (float)imgpos.x + imgw / 2.0f,
                               (float)imgpos.y + imgh / 2.0f });
-            m_cursorUpdater = [this, imgw, imgh, maxr](int audioPos)
+            m_cursorUpdater = [this, imgw, imgh, maxr](uint64_t audioPos)
             {
-                const float progress =
-                    (float)audioPos / static_cast<float>(m_audioBuffer.size());
+                const float progress = static_cast<float>(
+                    audioPos / static_cast<double>(m_audioBuffer.size()));
                 m_ci->setRadius(maxr - progress * maxr);
             };
         }
@@ -866,10 +1135,10 @@ Sonify::updateCursorUpdater() noexcept
 
             m_ci->setCenter({ (float)m_texture->pos().x + imgw / 2.0f,
                               (float)m_texture->pos().y + imgh / 2.0f });
-            m_cursorUpdater = [this, imgw, imgh, maxr](int audioPos)
+            m_cursorUpdater = [this, imgw, imgh, maxr](uint64_t audioPos)
             {
-                const float progress =
-                    (float)audioPos / static_cast<float>(m_audioBuffer.size());
+                const float progress = static_cast<float>(
+                    audioPos / static_cast<double>(m_audioBuffer.size()));
                 m_ci->setRadius(progress * maxr);
             };
         }
@@ -882,10 +1151,10 @@ Sonify::updateCursorUpdater() noexcept
             m_li->setHeight(m_cursor_thickness);
             m_li->setWidth(imgw);
             m_li->setPos({ imgpos.x + imgw, imgpos.y + imgh / 2 });
-            m_cursorUpdater = [this](int audioPos)
+            m_cursorUpdater = [this](uint64_t audioPos)
             {
-                const float progress =
-                    (float)audioPos / static_cast<float>(m_audioBuffer.size());
+                const float progress = static_cast<float>(
+                    audioPos / static_cast<double>(m_audioBuffer.size()));
                 m_li->setAngle(progress * 360.0f + 180.0f);
             };
         }
@@ -898,10 +1167,10 @@ Sonify::updateCursorUpdater() noexcept
             m_li->setHeight(m_cursor_thickness);
             m_li->setWidth(imgw);
             m_li->setPos({ imgpos.x + imgw, imgpos.y + imgh / 2 });
-            m_cursorUpdater = [this](int audioPos)
+            m_cursorUpdater = [this](uint64_t audioPos)
             {
-                const float progress =
-                    (float)audioPos / static_cast<float>(m_audioBuffer.size());
+                const float progress = static_cast<float>(
+                    audioPos / static_cast<double>(m_audioBuffer.size()));
                 m_li->setAngle(-progress * 360.0f + 180.0f);
             };
         }
@@ -912,12 +1181,12 @@ Sonify::updateCursorUpdater() noexcept
             if (!m_pi) m_pi = new PathItem();
             auto pixels = m_pi->pixels();
 
-            m_cursorUpdater = [this, pixels](int audioPos)
+            m_cursorUpdater = [this, pixels](uint64_t audioPos)
             {
                 if (pixels.empty()) return;
 
-                const float progress =
-                    (float)audioPos / static_cast<float>(m_audioBuffer.size());
+                const float progress = static_cast<float>(
+                    audioPos / static_cast<double>(m_audioBuffer.size()));
                 int pixelIndex = static_cast<int>(progress * pixels.size());
                 pixelIndex =
                     std::min(pixelIndex, static_cast<int>(pixels.size() - 1));
@@ -998,9 +1267,8 @@ Sonify::parse_args(const argparse::ArgumentParser &args) noexcept
 
     if (args.is_used("--no-spectrum")) m_display_fft_spectrum = false;
 
-    // TODO
-    // if (args.is_used("--channels"))
-    //     setChannels(std::stoi(args.get("--channels")));
+    if (args.is_used("--channels"))
+        m_channels = std::clamp(args.get<int>("--channels"), 1, 8);
 
     if (args.is_used("--traversal"))
         m_traversal_type =
@@ -1016,6 +1284,55 @@ Sonify::parse_args(const argparse::ArgumentParser &args) noexcept
 
     if (args.is_used("--fps")) m_fps = args.get<unsigned int>("--fps");
 
+    if (args.is_used("--angles"))
+        m_angular_resolution = args.get<int>("--angles");
+
+    if (args.is_used("--stream")) m_streaming = true;
+
+    if (args.is_used("--memoize")) m_memoize = true;
+
+    if (args.is_used("--skip-silent")) m_skip_silent = true;
+
+    if (args.is_used("--batch")) m_batchInput = args.get("--batch");
+
+    if (args.is_used("--batch-output"))
+        m_batchOutput = args.get("--batch-output");
+
+    if (args.is_used("--jobs")) m_jobs = args.get<unsigned int>("--jobs");
+
+    if (args.is_used("--band-rows"))
+        m_band_rows = args.get<int>("--band-rows");
+
+    if (args.is_used("--threads"))
+        m_threads = args.get<unsigned int>("--threads");
+
+    if (args.is_used("--timeline-dir"))
+        m_timeline_dir = args.get("--timeline-dir");
+
+    if (args.is_used("--sample-format") &&
+        !WavWriter::parseFormat(args.get("--sample-format"), m_sample_format))
+        TraceLog(LOG_WARNING, "Unknown sample format, using s16");
+
+    if (args.is_used("--buffer-frames"))
+        m_buffer_frames =
+            std::max(args.get<unsigned int>("--buffer-frames"), 64u);
+
+    if (args.is_used("--low-latency")) m_low_latency = true;
+
+    if (args.is_used("--audio-format") &&
+        !PlaybackFeeder::parseFormat(args.get("--audio-format"), m_audio_format))
+        TraceLog(LOG_WARNING, "Unknown audio format, using s16");
+
+    if (args.is_used("--spectrogram")) m_spectrogram = true;
+
+    if (args.is_used("--spectrogram-scale") &&
+        !SpectrogramRenderer::parseScale(args.get("--spectrogram-scale"),
+                                         m_spectrogram_scale))
+        TraceLog(LOG_WARNING, "Unknown spectrogram scale, using log");
+
+    if (args.is_used("--griffin-lim"))
+        m_griffin_lim = args.get<int>("--griffin-lim");
+
     if (args.is_used("--input"))
         m_openFileNameRequested = args.get<std::string>("--input");
 }
@@ -1024,13 +1341,11 @@ void
 Sonify::setSamplerate(float SR) noexcept
 {
     m_sampleRate = SR;
-    if (IsAudioStreamValid(m_stream))
-    {
-        StopAudioStream(m_stream);
-        UnloadAudioStream(m_stream);
-    }
-    m_stream = LoadAudioStream(m_sampleRate, 16, m_channels);
-    SetAudioStreamCallback(m_stream, &Sonify::audioCallback);
+
+    // called again once the device is up, offline renders never open it
+    if (!IsAudioDeviceReady()) return;
+
+    loadAudioStream();
 }
 
 void
@@ -1064,16 +1379,19 @@ Sonify::seekCursor(float seconds) noexcept
         static_cast<size_t>(m_sampleRate * m_channels);
 
     long long offset = static_cast<long long>(seconds * samplesPerSecond);
-    long long newPos = static_cast<long long>(m_audioReadPos) + offset;
+    long long newPos = static_cast<long long>(m_feeder->position()) + offset;
 
     if (newPos < 0) newPos = 0;
     if (newPos >= static_cast<long long>(m_audioBuffer.size()))
         newPos = static_cast<long long>(m_audioBuffer.size());
+    newPos -= newPos % m_channels; // start of a frame
 
-    m_audioReadPos = static_cast<unsigned int>(newPos);
+    m_requestTime = steadyNs();
+    m_feeder->seek(static_cast<uint64_t>(newPos));
+    m_streamer->seek(static_cast<uint64_t>(newPos));
 
     // Notify cursor position
-    if (m_cursorUpdater) m_cursorUpdater(m_audioReadPos);
+    if (m_cursorUpdater) m_cursorUpdater(static_cast<uint64_t>(newPos));
 }
 
 bool
@@ -1082,16 +1400,19 @@ Sonify::saveAudio(const std::string &fileName) noexcept
     if (!m_isSonified || m_audioBuffer.empty() || fileName.empty())
         return false;
 
-    Wave wave = { .frameCount = static_cast<unsigned int>(m_audioBuffer.size() /
-                                                          m_channels),
-                  .sampleRate = m_sampleRate,
-                  .sampleSize = 16,
-                  .channels   = m_channels,
-                  .data       = (void *)m_audioBuffer.data() };
+    // the file needs every column, not just the ones played so far
+    m_streamer->wait();
+
+    const std::string path = replaceHome(fileName);
 
-    std::string path = replaceHome(fileName);
+    WavWriter wav;
+    bool ok = wav.open(path, static_cast<unsigned int>(m_sampleRate),
+                       m_channels, m_sample_format);
+    for (size_t i = 0; ok && i < m_audioBuffer.chunks(); ++i)
+        ok = wav.write(m_audioBuffer.chunk(i));
+    ok = wav.close() && ok;
 
-    if (!ExportWave(wave, fileName.c_str()))
+    if (!ok)
     {
         TraceLog(LOG_ERROR, "Unable to export wave to %s", path.c_str());
         return false;
@@ -1146,10 +1467,12 @@ Sonify::loadDefaultPixelMappings() noexcept
     MapTemplate *map1 = new IntensityMap();
     MapTemplate *map2 = new HSVMap();
     MapTemplate *map3 = new FiveSegmentMap();
+    MapTemplate *map4 = new AdditiveMap();
 
     m_pixelMapManager->addMap({ "Intensity", nullptr, map1 });
     m_pixelMapManager->addMap({ "HSV", nullptr, map2 });
     m_pixelMapManager->addMap({ "FiveSegment", nullptr, map3 });
+    m_pixelMapManager->addMap({ "Additive", nullptr, map4 });
 }
 
 void
@@ -1199,23 +1522,14 @@ Sonify::renderFFT() noexcept
 {
     if (m_audioBuffer.empty()) return;
 
-    constexpr size_t FFT_SIZE = 1024;
-    using namespace sonify;
-
-    vec_complex fft_input(FFT_SIZE);
-    size_t start =
-        (m_audioReadPos < FFT_SIZE) ? 0 : (size_t)m_audioReadPos - FFT_SIZE;
-
-    for (size_t i = 0; i < FFT_SIZE; i++)
+    // Analyzed once the audio is complete, then only looked up
+    if (m_spectrumPending && (!m_streamer->active() || m_streamer->finished()))
     {
-        size_t idx    = start + i;
-        double sample = (idx < m_audioBuffer.size()) ? m_audioBuffer[idx] : 0.0;
-        fft_input.emplace_back(sample, 0.0);
+        m_analyzer->start(m_audioBuffer, m_sampleRate, m_channels);
+        m_spectrumPending = false;
     }
 
-    FFT(fft_input); // in-place
-
-    DrawSpectrum(fft_input, m_image.width, m_image.height, 100, 0);
+    m_analyzer->draw(m_feeder->position(), m_image.width, m_image.height, 100);
 }
 
 void
@@ -1229,7 +1543,10 @@ Sonify::readConfigFile() noexcept
     auto toml    = toml::parse_file(config_file_path);
     auto general = toml["general"];
     auto ui      = toml["ui"];
-    auto cmdline = toml["cmdline"];
+    auto cmdline     = toml["cmdline"];
+    auto performance = toml["performance"];
+    auto spectrogram = toml["spectrogram"];
+    auto audio       = toml["audio"];
 
     if (general)
     {
@@ -1241,6 +1558,10 @@ Sonify::readConfigFile() noexcept
         m_sampleRate          = general["sample-rate"].value_or(44100.0f);
         m_duration_per_sample = general["duration-per-sample"].value_or(0.05f);
         m_loop                = general["loop"].value_or(false);
+        m_angular_resolution  = general["angular-resolution"].value_or(360);
+        m_channels = std::clamp(general["channels"].value_or(1), 1, 8);
+        WavWriter::parseFormat(general["sample-format"].value_or("s16"),
+                               m_sample_format);
         auto limit_dim        = general["limit-dimension"];
         if (limit_dim)
         {
@@ -1260,6 +1581,88 @@ Sonify::readConfigFile() noexcept
         m_font_size        = ui["font-size"].value_or<int>(60);
     }
     if (cmdline) { m_silence = cmdline["silent"].value_or(false); }
+    if (performance)
+    {
+        m_threads     = performance["threads"].value_or<unsigned int>(0);
+        m_streaming   = performance["streaming"].value_or(false);
+        m_memoize     = performance["memoize"].value_or(false);
+        m_skip_silent = performance["skip-silent"].value_or(false);
+        m_band_rows   = performance["band-rows"].value_or(0);
+        m_jobs        = performance["jobs"].value_or<unsigned int>(0);
+        m_timeline_dir =
+            performance["timeline-dir"].value_or<std::string>("");
+    }
+    if (spectrogram)
+    {
+        m_spectrogram = spectrogram["enabled"].value_or(false);
+        m_griffin_lim = spectrogram["iterations"].value_or(0);
+        SpectrogramRenderer::parseScale(
+            spectrogram["scale"].value_or("log"), m_spectrogram_scale);
+    }
+    if (audio)
+    {
+        m_buffer_frames =
+            std::max(audio["buffer-frames"].value_or<unsigned int>(4096), 64u);
+        m_low_latency   = audio["low-latency"].value_or(false);
+        PlaybackFeeder::parseFormat(audio["audio-format"].value_or("s16"),
+                                    m_audio_format);
+    }
+}
+
+bool
+Sonify::isVideoFile(const std::string &path) noexcept
+{
+    std::string ext = std::filesystem::path(path).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".mp4" || ext == ".mkv" || ext == ".mov" || ext == ".webm";
+}
+
+bool
+Sonify::renderVideoOffline() noexcept
+{
+    if (m_audioBuffer.empty() || m_pixels.empty()) return false;
+
+    if (m_traversal_type == TraversalType::PATH ||
+        m_traversal_type == TraversalType::REGION)
+    {
+        TraceLog(LOG_ERROR, "Offline video needs a traversal that does not "
+                            "depend on user input");
+        return false;
+    }
+
+    VideoRenderer::Options options;
+    options.fps        = m_fps;
+    options.sampleRate = static_cast<unsigned int>(m_sampleRate);
+    options.channels   = m_channels;
+    options.background = m_bg;
+    options.thickness  = static_cast<int>(m_cursor_thickness);
+
+    if (!m_silence) TraceLog(LOG_INFO, "Rendering video...");
+
+    VideoRenderer renderer(m_engine->pool(), options);
+    if (!renderer.render(m_pixels, m_traversal_type, m_audioBuffer,
+                         replaceHome(m_outputFileName)))
+        return false;
+
+    m_videoExported = true;
+    return true;
+}
+
+void
+Sonify::readbackFrame(const RenderTexture2D &target) noexcept
+{
+    // raylib has no asynchronous (PBO) readback, this copies the texture
+    // into a recycled buffer and leaves the write to the writer thread
+    Image frame = LoadImageFromTexture(target.texture);
+    if (!IsImageValid(frame)) return;
+
+    FrameWriter::Buffer buffer = m_frameWriter->acquire();
+    const size_t bytes = (size_t)frame.width * (size_t)frame.height * 4;
+    buffer.resize(bytes);
+    std::memcpy(buffer.data(), frame.data, bytes);
+    UnloadImage(frame);
+
+    m_frameWriter->submit(std::move(buffer));
 }
 
 bool
@@ -1276,22 +1679,52 @@ Sonify::renderVideo() noexcept
         return false;
     }
 
-    const char *audioFileName = "/tmp/sonify__tmp.wav";
+    if (m_outputFileName.empty()) m_outputFileName = "./output.mp4";
+
+    // a dead encoder must fail the writes, not kill the process
+    std::signal(SIGPIPE, SIG_IGN);
 
-    if (!m_audioExported && !saveAudio(audioFileName))
+    // frames are sent as read back from OpenGL, bottom row first
+    if (!ffmpeg_video_audio_pipes(m_screenW, m_screenH, m_fps,
+                                  static_cast<unsigned int>(m_sampleRate),
+                                  m_channels, m_outputFileName.c_str(),
+                                  m_ffmpeg, true))
     {
-        TraceLog(LOG_ERROR, "Could not save audio!"
-                            "Cannot render the video!");
+        TraceLog(LOG_ERROR, "Unable to start ffmpeg");
         return false;
     }
 
-    if (m_outputFileName.empty()) m_outputFileName = "./output.mp4";
+    // ffmpeg reads both inputs as it goes, feed the audio from its own
+    // thread. No input is handled while recording, so the timeline stays
+    // put until finishRecording() joins it.
+    m_streamer->wait();
+    m_audioWriteOk = true;
+    m_audioWriter  = std::thread([this]()
+    {
+        for (size_t i = 0; i < m_audioBuffer.chunks() && m_audioWriteOk; ++i)
+        {
+            const auto chunk = m_audioBuffer.chunk(i);
+            m_audioWriteOk   = std::fwrite(chunk.data(), sizeof(short),
+                                           chunk.size(),
+                                           m_ffmpeg.audio) == chunk.size();
+        }
+        m_audioWriteOk = std::fclose(m_ffmpeg.audio) == 0 && m_audioWriteOk;
+        m_ffmpeg.audio = nullptr;
+    });
 
-    m_ffmpeg = ffmpeg_audio_video(m_screenW, m_screenH, m_fps, audioFileName,
-                                  m_outputFileName.c_str());
-    if (!m_ffmpeg) return false;
-    if (!IsTextureValid(m_recordTarget.texture))
-        m_recordTarget = LoadRenderTexture(m_screenW, m_screenH);
+    for (auto &target : m_recordTargets)
+    {
+        if (IsRenderTextureValid(target) &&
+            (target.texture.width != m_screenW ||
+             target.texture.height != m_screenH))
+            UnloadRenderTexture(target);
+        if (!IsRenderTextureValid(target))
+            target = LoadRenderTexture(m_screenW, m_screenH);
+    }
+
+    if (!m_frameWriter) m_frameWriter = new FrameWriter();
+    m_frameWriter->start(m_ffmpeg.video, (size_t)m_screenW * m_screenH * 4);
+    m_recordFrame = 0;
     m_videoExported  = true;
     m_recordingState = RecordingState::RECORDING;
     recenterView();
@@ -1300,131 +1733,69 @@ Sonify::renderVideo() noexcept
     return true;
 }
 
-// Reloads the currenly loaded pixel map from the shared object
+// Ends the input of the encoder started by renderVideo and waits for it
+bool
+Sonify::finishRecording() noexcept
+{
+    bool ok        = m_frameWriter->finish();
+    ok             = std::fclose(m_ffmpeg.video) == 0 && ok;
+    m_ffmpeg.video = nullptr;
+
+    // end of the video input, ffmpeg may be waiting for it to read the audio
+    if (m_audioWriter.joinable()) m_audioWriter.join();
+    ok = ffmpeg_wait(m_ffmpeg) && ok && m_audioWriteOk;
+
+    if (!ok)
+        TraceLog(LOG_ERROR, "Video export to %s failed",
+                 m_outputFileName.c_str());
+    return ok;
+}
+
+// Reloads the currenly loaded pixel map from the shared object, in the
+// background like a rebuilt one
 void
 Sonify::reloadCurrentPixelMappingSharedObject() noexcept
 {
-    if (m_pixelMapName.empty()) return;
+    if (m_pixelMapName.empty() || !m_pluginWatcher) return;
 
-    // simple guard to avoid concurrent reloads
-    std::lock_guard<std::mutex> reloadLock(m_reloadMutex);
-
-    // Save playback state
-    const PlaybackState state = m_playbackState;
-    const size_t tempPos      = m_audioReadPos;
+    m_pluginWatcher->reload(m_mappings_dir + m_pixelMapName + ".so");
+}
 
-    // Pause audio playback safely so audio callback won't be
-    // racing on buffers
-    if (state == PlaybackState::PLAYING)
-    {
-        PauseAudioStream(m_stream); // pause the stream
-        m_playbackState = PlaybackState::STOPPED;
-    }
+void
+Sonify::updatePlugins() noexcept
+{
+    // Renders started before a swap may still be calling the retired maps
+    const bool rendering = m_resynth->busy() ||
+                           (m_streamer->active() && !m_streamer->finished());
+    if (m_pixelMapManager->hasRetired() && !rendering)
+        m_pixelMapManager->releaseRetired();
 
-    // Reload the shared object (this will call remove() ->
-    // destroy + dlclose -> then add new)
-    loadPixelMappingsSharedObject(m_mappings_dir + m_pixelMapName + ".so");
+    PixelMap *p = m_pluginWatcher ? m_pluginWatcher->take() : nullptr;
+    if (!p) return;
 
-    // Re-generate audio using the new mapping. sonification()
-    // will fetch the map via
-    // m_pixelMapManager->getMapTemplate(m_pixelMapName)
-    sonification();
+    const std::string name = p->name;
+    m_pixelMapManager->replace(*p);
+    delete p;
 
-    // Restore position and cursor
-    m_audioReadPos = tempPos;
-    if (m_cursorUpdater) m_cursorUpdater(m_audioReadPos);
+    if (!m_silence) TraceLog(LOG_INFO, "Reloaded mapping %s", name.c_str());
 
-    // Resume playback if it was playing before
-    if (state == PlaybackState::STOPPED)
-    {
-        // Reset stream read pointer and resume
-        // Note: we paused the stream; if you previously used
-        // StopAudioStream you may need to PlayAudioStream
-        PlayAudioStream(m_stream);
-        m_playbackState = PlaybackState::PLAYING;
-    }
+    // heard after a background render, playback goes on meanwhile
+    if (name == m_pixelMapName) requestResynthesis();
 }
 
 // Load the given shared object from path
 void
 Sonify::loadPixelMappingsSharedObject(const std::string &filepath) noexcept
 {
-    std::filesystem::path sopath(filepath);
-    const std::string name = sopath.stem().string();
-
-    m_pixelMapManager->remove(name);
-
-    void *handle = dlopen(filepath.c_str(), RTLD_NOW | RTLD_LOCAL);
-
-    if (!handle)
-    {
-        TraceLog(LOG_WARNING, "dlopen failed for %s: %s", filepath.c_str(),
-                 dlerror());
-        return;
-    }
-
-    auto create  = reinterpret_cast<CreateFn>(dlsym(handle, "create"));
-    auto destroy = reinterpret_cast<DestroyFn>(dlsym(handle, "destroy"));
-
-    if (!create || !destroy)
-    {
-        TraceLog(LOG_WARNING, "Plugin missing create/destroy: %s",
-                 filepath.c_str());
-        dlclose(handle);
-        return;
-    }
-
-    void *symCreate = (dlsym(handle, "create"));
-
-    if (!symCreate)
-    {
-        TraceLog(LOG_WARNING, "create symbol missing in %s: %s",
-                 filepath.c_str(), dlerror());
-        dlclose(handle);
-        return;
-    }
-
-    // get destroy
-    void *symDestroy = dlsym(handle, "destroy");
-    if (symDestroy) { destroy = reinterpret_cast<DestroyFn>(symDestroy); }
-    else
-    {
-        // No destroy symbol: you can set destroy = nullptr and
-        // fall back to delete in manager.
-        TraceLog(LOG_WARNING,
-                 "destroy symbol missing in %s - fallback "
-                 "delete may be unsafe.",
-                 filepath.c_str());
-    }
-
-    // create the map (object exists while lib is loaded)
-    MapTemplate *map = nullptr;
-    try
-    {
-        map = create();
-    }
-    catch (...)
-    {
-        TraceLog(LOG_WARNING, "create() threw exception in %s",
-                 filepath.c_str());
-        if (handle) dlclose(handle);
-        return;
-    }
-
-    // Add to manager (name, handle, map, destroy)
     PixelMap pm;
-    pm.name    = name;
-    pm.handle  = handle;
-    pm.map     = map;
-    pm.destroy = destroy;
-
-    m_pixelMapManager->addMap(pm);
+    if (PluginWatcher::load(filepath, pm)) m_pixelMapManager->replace(pm);
 }
 
 void
 Sonify::toggleLooping() noexcept
 {
     m_loop = !m_loop;
+    m_feeder->setLoop(m_loop);
 }
 
 void
@@ -1449,12 +1820,40 @@ Sonify::renderStats() noexcept
 
     drawStat("LOOP: ", std::to_string(m_loop));
     drawStat("VOL: ", TextFormat("%.2f", GetMasterVolume()));
+    drawStat("LATENCY: ",
+             TextFormat("%.1f ms, %u frames %s, %u underruns",
+                        m_latency.load(), m_buffer_frames,
+                        m_audio_format == PlaybackFeeder::Format::F32 ? "f32"
+                                                                      : "s16",
+                        m_underruns.load()));
     if (m_texture)
     {
         drawStat("DIM: ",
                  TextFormat("%d, %d", m_texture->width(), m_texture->height()));
     }
     else { drawStat("No Image Loaded", ""); }
+
+    if (m_streaming && m_streamer->columns() > 0)
+    {
+        drawStat("STREAM: ", TextFormat("%zu/%zu",
+                                        m_streamer->renderedColumns(),
+                                        m_streamer->columns()));
+    }
+
+    drawStat("TUNE: ", TextFormat("%s, %.0f-%.0f Hz, %.3f s%s",
+                                  m_pixelMapName.c_str(), m_min_freq,
+                                  m_max_freq, m_duration_per_sample,
+                                  m_resynth->busy() || m_resynthPending
+                                      ? " (rendering)"
+                                      : ""));
+
+    // the memo is rebuilt while a live render runs
+    if ((m_memoize || m_skip_silent) && !m_resynth->busy())
+    {
+        const auto stats = m_engine->memoStats();
+        drawStat("MEMO: ", TextFormat("%zu hit, %zu miss, %zu silent",
+                                      stats.hits, stats.misses, stats.silent));
+    }
 }
 
 void
@@ -1,14 +1,27 @@
 #pragma once
 
+#include "AudioTimeline.hpp"
 #include "CircleItem.hpp"
 #include "DTexture.hpp"
 #include "FFT.hpp"
+#include "FrameWriter.hpp"
 #include "LineItem.hpp"
 #include "PathItem.hpp"
 #include "PixelMapManager.hpp"
+#include "PixelStore.hpp"
+#include "PlaybackFeeder.hpp"
+#include "PluginWatcher.hpp"
+#include "Resynthesizer.hpp"
+#include "SonificationEngine.hpp"
+#include "SpectrogramRenderer.hpp"
+#include "SpectrumAnalyzer.hpp"
+#include "StreamingRenderer.hpp"
 #include "Timer.hpp"
+#include "WavWriter.hpp"
 #include "argparse.hpp"
+#include "ffmpeg.hpp"
 #include "raylib.h"
+#include "sonify/DefaultPixelMappings/AdditiveMap.hpp"
 #include "sonify/DefaultPixelMappings/FiveSegment.hpp"
 #include "sonify/DefaultPixelMappings/HSVMap.hpp"
 #include "sonify/DefaultPixelMappings/IntensityMap.hpp"
@@ -16,11 +29,11 @@
 #include "sonify/utils.hpp"
 #include "toml.hpp"
 
-#include <fftw3.h>
+#include <atomic>
 #include <functional>
-#include <mutex>
 #include <print>
 #include <string>
+#include <thread>
 
 #define LOG(...)         std::println(__VA_ARGS__);
 #define __SONIFY_VERSION "0.2.0"
@@ -40,6 +53,39 @@ private:
     static void audioCallback(void *bufferData, unsigned int frames);
 
     void sonification() noexcept;
+    // Headless row traversal of a PNM/PAM image straight from disk to WAV
+    bool sonifyOutOfCore() noexcept;
+    // Offline render written to the output a block at a time, the audio is
+    // never held in memory as a whole
+    bool sonifyToFile() noexcept;
+    // Image read as the magnitude of a spectrogram, see SpectrogramRenderer
+    bool sonifySpectrogram() noexcept;
+    // --headless: offline render to the output file, or play without a window
+    void runHeadless() noexcept;
+    // Frames composed on the CPU, for headless runs with a video output
+    bool renderVideoOffline() noexcept;
+    static bool isVideoFile(const std::string &path) noexcept;
+    // Queues the frame held by `target` for the encoder
+    void readbackFrame(const RenderTexture2D &target) noexcept;
+    void initAudio() noexcept;
+    // (Re)creates m_stream with the current rate, format and buffer size
+    void loadAudioStream() noexcept;
+    // --low-latency: doubles the stream buffer after an underrun
+    void adaptBufferSize() noexcept;
+    // Queues the sonified audio for the device, from the playback position
+    void startFeeder(bool crossfade = false) noexcept;
+    // Live tuning: parameters edited while playing are rendered into
+    // m_backBuffer in the background, which then takes over with a crossfade
+    void requestResynthesis() noexcept;
+    void updateResynthesis() noexcept;
+    // Swaps in the mappings the watcher reloaded, frees the retired ones
+    void updatePlugins() noexcept;
+    // Engine, streamer and mappings, shared by the GUI and headless modes
+    void initSonification() noexcept;
+    // Sonifies every image of m_batchInput, then prints a timing summary
+    bool runBatch() noexcept;
+    // The selected mapping with the current parameters applied
+    MapTemplate *currentMapTemplate() noexcept;
     void GUIloop() noexcept;
     void render() noexcept;
     void handleMouseScroll() noexcept;
@@ -50,33 +96,6 @@ private:
     [[nodiscard("Get returned string")]] std::string
     replaceHome(const std::string_view &str) noexcept;
 
-    using AudioBuffer = std::vector<std::vector<short>>;
-    void collectLeftToRight(Color *pixels, int w, int h,
-                            AudioBuffer &buffer) noexcept;
-
-    void collectRightToLeft(Color *pixels, int w, int h,
-                            AudioBuffer &buffer) noexcept;
-
-    void collectTopToBottom(Color *pixels, int w, int h,
-                            AudioBuffer &buffer) noexcept;
-
-    void collectBottomToTop(Color *pixels, int w, int h,
-                            AudioBuffer &buffer) noexcept;
-
-    void collectClockwise(Color *pixels, int w, int h,
-                          AudioBuffer &buffer) noexcept;
-
-    void collectCircleOutwards(Color *pixels, int w, int h,
-                               AudioBuffer &buffer) noexcept;
-
-    void collectCircleInwards(Color *pixels, int w, int h,
-                              AudioBuffer &buffer) noexcept;
-
-    void collectRegion(Color *pixels, int w, int h,
-                       AudioBuffer &buffer) noexcept;
-
-    void collectAntiClockwise(Color *pixels, int w, int h,
-                              AudioBuffer &buffer) noexcept;
     void renderFFT() noexcept;
     void parse_args(const argparse::ArgumentParser &) noexcept;
     void setSamplerate(float SR) noexcept;
@@ -111,6 +130,7 @@ private:
     void handleFileDrop() noexcept;
     void readConfigFile() noexcept;
     bool renderVideo() noexcept;
+    bool finishRecording() noexcept;
     void renderStats() noexcept;
     void reloadCurrentPixelMappingSharedObject() noexcept;
     void toggleLooping() noexcept;
@@ -122,25 +142,8 @@ private:
 
 private:
 
-    using PixelMapFunc =
-        std::function<std::vector<short>(const std::vector<Pixel> &)>;
-    PixelMapFunc m_mapFunc;
-    using CursorUpdater = std::function<void(unsigned int pos)>;
+    using CursorUpdater = std::function<void(uint64_t pos)>;
     CursorUpdater m_cursorUpdater;
-    enum class TraversalType
-    {
-        LEFT_TO_RIGHT = 0,
-        RIGHT_TO_LEFT,
-        TOP_TO_BOTTOM,
-        BOTTOM_TO_TOP,
-        CIRCLE_INWARDS,
-        CIRCLE_OUTWARDS,
-        CLOCKWISE,
-        ANTICLOCKWISE,
-        PATH,
-        REGION
-    };
-
     enum class PlaybackState
     {
         STOPPED = 0,
@@ -157,8 +160,10 @@ private:
 
     DTexture *m_texture{ nullptr };
     Image m_image;
+    PixelStore m_pixels; // decoded m_image, reused between sonifications
     AudioStream m_stream{ 0 };
-    std::vector<short> m_audioBuffer;
+    AudioTimeline m_audioBuffer;
+    AudioTimeline m_backBuffer; // live resynthesis, swapped in when done
     std::string m_outputFileName;
 
     // used to store the file name to be opened through the command
@@ -170,24 +175,40 @@ private:
     CircleItem *m_ci{ nullptr };
     PathItem *m_pi{ nullptr };
 
-    PlaybackState m_playbackState{ PlaybackState::STOPPED };
-    RecordingState m_recordingState{ RecordingState::NONE };
+    // also set by the audio thread
+    std::atomic<PlaybackState> m_playbackState{ PlaybackState::STOPPED };
+    std::atomic<RecordingState> m_recordingState{ RecordingState::NONE };
 
     bool m_isSonified{ false };    // audio data ready
     bool m_audioExported{ false }; // has user saved audio?
     bool m_videoExported{ false }; // has user saved video?
 
     bool m_showDragDropText{ true }; // UI only
-    bool m_exit_requested{ false };
+    std::atomic<bool> m_exit_requested{ false }; // set by the audio thread
 
     float m_showNotSonifiedMessageTimer{ 1.5f };
-    unsigned int m_audioReadPos{ 0 };
 
     bool m_showNotSonifiedMessage{ false };
 
     Camera2D m_camera;
     int m_screenW, m_screenH;
     PixelMapManager *m_pixelMapManager{ nullptr };
+    PluginWatcher *m_pluginWatcher{ nullptr }; // GUI only
+    SonificationEngine *m_engine{ nullptr };
+    StreamingRenderer *m_streamer{ nullptr };
+    SpectrumAnalyzer *m_analyzer{ nullptr };
+    PlaybackFeeder *m_feeder{ nullptr }; // all the audio thread reads
+    Resynthesizer *m_resynth{ nullptr };
+    bool m_resynthPending{ false }; // edits not rendered yet
+    double m_lastEdit{ 0 };         // GetTime() of the last edit
+
+    // Callback timing, for the stats and the low-latency preset
+    std::atomic<int64_t> m_requestTime{ 0 };  // ns, play/seek not yet heard
+    std::atomic<int64_t> m_lastCallback{ 0 }; // ns, 0 after a pause
+    std::atomic<unsigned int> m_underruns{ 0 };
+    std::atomic<float> m_latency{ 0 }; // ms, last request to output
+    unsigned int m_handledUnderruns{ 0 };
+    bool m_spectrumPending{ false }; // analyze once the audio is complete
 
     std::string m_dragDropText{ "Drop an image file here to sonify" };
     const std::string m_mappings_dir =
@@ -198,10 +219,15 @@ private:
     float m_font_size{ 30 };
     Timer m_timer;
     unsigned int m_window_config_flags;
-    RenderTexture2D m_recordTarget{};
-    FILE *m_ffmpeg{ nullptr };
-
-    std::mutex m_reloadMutex;
+    // Frames are rendered into a ring of textures and read back a few frames
+    // later, once the GPU is done with them
+    static constexpr size_t RECORD_RING = 3;
+    RenderTexture2D m_recordTargets[RECORD_RING]{};
+    size_t m_recordFrame{ 0 };
+    FrameWriter *m_frameWriter{ nullptr };
+    FFmpegPipes m_ffmpeg;
+    std::thread m_audioWriter; // the timeline into m_ffmpeg.audio
+    bool m_audioWriteOk{ false };
 
     // COMMAND LINE ARGUMENTS
     TraversalType m_traversal_type{ 0 };
@@ -210,6 +236,9 @@ private:
     float m_max_freq{ 20000 };
     float m_sampleRate{ 44100.0f };
     unsigned int m_channels{ 1 };
+    unsigned int m_buffer_frames{ 4096 }; // stream buffer, see loadAudioStream
+    bool m_low_latency{ false };
+    PlaybackFeeder::Format m_audio_format{ PlaybackFeeder::Format::S16 };
     unsigned int m_fps{ 60 };
     MapTemplate::FreqMapFunc m_freq_map_func{ utils::LinearMap };
     Color m_bg{ ColorFromHex(0x000000) };
@@ -220,6 +249,22 @@ private:
     bool m_silence{ false }; // handles displaying INFO/WARNING messages
     unsigned int m_cursor_thickness{ 1 };
     bool m_renderStats{ false };
+    unsigned int m_threads{ 0 }; // 0 = hardware concurrency
+    int m_angular_resolution{ 360 };
+    bool m_streaming{ false }; // render while playing instead of up front
+    bool m_memoize{ false };     // reuse samples of repeated columns
+    bool m_skip_silent{ false }; // black/transparent columns are silent
+    int m_band_rows{ 0 };        // rows per band out-of-core, 0 = off
+    std::string m_batchInput;    // directory, glob or list of images
+    std::string m_batchOutput;   // output pattern, see BatchRunner
+    unsigned int m_jobs{ 0 };    // images in flight in batch mode
+    WavWriter::Format m_sample_format{ WavWriter::Format::PCM16 };
+    std::string m_timeline_dir; // mapped file for the audio, empty = RAM
+    bool m_spectrogram{ false }; // image is an STFT magnitude
+    SpectrogramRenderer::Scale m_spectrogram_scale{
+        SpectrogramRenderer::Scale::LOG
+    };
+    int m_griffin_lim{ 0 }; // phase reconstruction iterations
 };
 
 static Sonify *gInstance{ nullptr };
@@ -0,0 +1,230 @@
+#include "SpectrogramRenderer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    // Per worker buffers of one frame
+    struct FrameScratch
+    {
+        std::vector<double> mag, samples;
+        sonify::vec_complex spectrum;
+    };
+
+    // Deterministic start phase of bin `k` of `frame`
+    inline float randomPhase(size_t frame, size_t k) noexcept
+    {
+        uint64_t h = (frame * 0x9E3779B97F4A7C15ull) ^ (k * 0xBF58476D1CE4E5B9ull);
+        h ^= h >> 31;
+        h *= 0x94D049BB133111EBull;
+        h ^= h >> 29;
+        return static_cast<float>((h >> 11) * (2.0 * M_PI / 9007199254740992.0));
+    }
+} // namespace
+
+SpectrogramRenderer::SpectrogramRenderer(ThreadPool &pool,
+                                         const Options &options) noexcept
+    : m_pool(pool), m_options(options)
+{
+    m_options.hop = std::max<size_t>(1, m_options.hop);
+
+    m_size = 256;
+    while (m_size < 2 * m_options.hop)
+        m_size <<= 1;
+    m_bins = m_size / 2 + 1;
+    m_plan = &sonify::FFTPlan::get(m_size);
+
+    // periodic Hann, used for analysis and synthesis
+    m_window.resize(m_size);
+    for (size_t i = 0; i < m_size; ++i)
+        m_window[i] = 0.5 - 0.5 * std::cos(2.0 * M_PI * i / m_size);
+}
+
+bool
+SpectrogramRenderer::parseScale(const std::string &name, Scale &scale) noexcept
+{
+    if (name == "linear") scale = Scale::LINEAR;
+    else if (name == "log") scale = Scale::LOG;
+    else return false;
+
+    return true;
+}
+
+void
+SpectrogramRenderer::mapBins(int height) noexcept
+{
+    const double nyquist = m_options.sampleRate / 2.0;
+    const double hi      = std::min<double>(m_options.maxFreq, nyquist);
+    double lo            = std::max<double>(m_options.minFreq, 0.0);
+    if (m_options.scale == Scale::LOG) lo = std::max(lo, 20.0);
+
+    m_binRow.assign(m_bins, -1);
+    m_binFrac.assign(m_bins, 0.0f);
+    if (hi <= lo || height <= 0) return;
+
+    for (size_t k = 0; k < m_bins; ++k)
+    {
+        const double f = k * static_cast<double>(m_options.sampleRate) /
+                         m_size;
+        if (f < lo || f > hi) continue;
+
+        // 0 at the top row (hi), 1 at the bottom one (lo)
+        const double t = m_options.scale == Scale::LOG
+                             ? std::log(hi / f) / std::log(hi / lo)
+                             : (hi - f) / (hi - lo);
+        const double row = t * (height - 1);
+
+        m_binRow[k]  = std::min(static_cast<int>(row), height - 1);
+        m_binFrac[k] = static_cast<float>(row - m_binRow[k]);
+    }
+}
+
+void
+SpectrogramRenderer::magnitudes(size_t frame,
+                                std::vector<double> &mag) const noexcept
+{
+    const int w         = m_pixels->width();
+    const int h         = m_pixels->height();
+    const Color *pixels = m_pixels->rows();
+
+    auto brightness = [&](int row) -> double
+    {
+        const Color c = pixels[static_cast<size_t>(row) * w + frame];
+        return std::max({ c.r, c.g, c.b }) * c.a / (255.0 * 255.0);
+    };
+
+    mag.resize(m_bins);
+    for (size_t k = 0; k < m_bins; ++k)
+    {
+        const int row = m_binRow[k];
+        if (row < 0)
+        {
+            mag[k] = 0.0;
+            continue;
+        }
+
+        const double a = brightness(row);
+        const double b = row + 1 < h ? brightness(row + 1) : a;
+        mag[k]         = a + (b - a) * m_binFrac[k];
+    }
+}
+
+void
+SpectrogramRenderer::forFrames(
+    const std::function<void(size_t frame, unsigned int worker)>
+        &func) noexcept
+{
+    // Frames g apart do not overlap, so the frames of one residue class can
+    // write to the signal at the same time
+    const size_t g = (m_size + m_options.hop - 1) / m_options.hop;
+    for (size_t r = 0; r < g && r < m_frames; ++r)
+    {
+        const size_t count = (m_frames - r + g - 1) / g;
+        m_pool.parallelFor(count, [&](size_t i, unsigned int worker)
+        { func(r + i * g, worker); });
+    }
+}
+
+void
+SpectrogramRenderer::synthesize() noexcept
+{
+    std::fill(m_signal.begin(), m_signal.end(), 0.0);
+
+    std::vector<FrameScratch> scratch(m_pool.size());
+    forFrames([&](size_t f, unsigned int worker)
+    {
+        FrameScratch &s = scratch[worker];
+        magnitudes(f, s.mag);
+
+        const float *phase = m_phase.data() + f * m_bins;
+        s.spectrum.resize(m_bins);
+        for (size_t k = 0; k < m_bins; ++k)
+            s.spectrum[k] = std::polar(s.mag[k], static_cast<double>(phase[k]));
+
+        s.samples.resize(m_size);
+        m_plan->inverseReal(s.spectrum, s.samples);
+
+        double *out = m_signal.data() + f * m_options.hop;
+        for (size_t i = 0; i < m_size; ++i)
+            out[i] += s.samples[i] * m_window[i];
+    });
+
+    for (size_t i = 0; i < m_signal.size(); ++i)
+        m_signal[i] /= m_norm[i];
+}
+
+void
+SpectrogramRenderer::analyze() noexcept
+{
+    std::vector<FrameScratch> scratch(m_pool.size());
+    m_pool.parallelFor(m_frames, [&](size_t f, unsigned int worker)
+    {
+        FrameScratch &s  = scratch[worker];
+        const double *in = m_signal.data() + f * m_options.hop;
+
+        s.samples.resize(m_size);
+        for (size_t i = 0; i < m_size; ++i)
+            s.samples[i] = in[i] * m_window[i];
+
+        s.spectrum.resize(m_bins);
+        m_plan->forwardReal(s.samples, s.spectrum);
+
+        float *phase = m_phase.data() + f * m_bins;
+        for (size_t k = 0; k < m_bins; ++k)
+            phase[k] = static_cast<float>(std::arg(s.spectrum[k]));
+    });
+}
+
+bool
+SpectrogramRenderer::render(const PixelStore &pixels,
+                            std::vector<short> &audio) noexcept
+{
+    audio.clear();
+    if (pixels.empty()) return false;
+
+    m_pixels = &pixels;
+    m_frames = static_cast<size_t>(pixels.width());
+    mapBins(pixels.height());
+
+    const size_t hop    = m_options.hop;
+    const size_t length = (m_frames - 1) * hop + m_size;
+
+    // sum of the squared windows over the frames covering each sample
+    m_norm.assign(length, 0.0);
+    for (size_t f = 0; f < m_frames; ++f)
+        for (size_t i = 0; i < m_size; ++i)
+            m_norm[f * hop + i] += m_window[i] * m_window[i];
+    for (double &n : m_norm)
+        n = std::max(n, 1e-3);
+
+    m_signal.assign(length, 0.0);
+    m_phase.resize(m_frames * m_bins);
+    for (size_t f = 0; f < m_frames; ++f)
+        for (size_t k = 0; k < m_bins; ++k)
+            m_phase[f * m_bins + k] = randomPhase(f, k);
+
+    synthesize();
+    for (int i = 0; i < m_options.iterations; ++i)
+    {
+        analyze();
+        synthesize();
+    }
+
+    // Frame f is centered on column f, which starts at sample f * hop
+    const size_t start = (m_size - hop) / 2;
+    double peak        = 0.0;
+    for (size_t i = start; i < start + m_frames * hop; ++i)
+        peak = std::max(peak, std::fabs(m_signal[i]));
+
+    const double gain = peak > 0.0 ? 0.9 * 32767.0 / peak : 0.0;
+    audio.resize(m_frames * hop);
+    for (size_t i = 0; i < audio.size(); ++i)
+        audio[i] = static_cast<short>(m_signal[start + i] * gain);
+
+    m_signal = {};
+    m_phase  = {};
+    m_norm   = {};
+    return true;
+}
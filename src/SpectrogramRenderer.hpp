@@ -0,0 +1,76 @@
+#pragma once
+
+#include "FFT.hpp"
+#include "PixelStore.hpp"
+#include "ThreadPool.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Treats the image as the magnitude of a short-time Fourier transform: every
+// column is a frame `hop` samples after the previous one and every row a
+// frequency, from maxFreq at the top to minFreq at the bottom, spaced
+// linearly or logarithmically. The audio is resynthesized by overlap-add of
+// inverse FFTs, optionally after a few Griffin-Lim iterations that look for
+// phases consistent with the magnitudes. Frames are transformed in parallel.
+class SpectrogramRenderer
+{
+public:
+
+    enum class Scale
+    {
+        LINEAR = 0,
+        LOG
+    };
+
+    struct Options
+    {
+        float sampleRate{ 44100.0f };
+        size_t hop{ 2205 }; // samples per column
+        float minFreq{ 0.0f }, maxFreq{ 20000.0f };
+        Scale scale{ Scale::LOG };
+        int iterations{ 0 }; // Griffin-Lim, 0 = random phases only
+    };
+
+    SpectrogramRenderer(ThreadPool &pool, const Options &options) noexcept;
+
+    // width() * hop samples into `audio`
+    bool render(const PixelStore &pixels, std::vector<short> &audio) noexcept;
+
+    // "linear" or "log"
+    static bool parseScale(const std::string &name, Scale &scale) noexcept;
+
+    // Frame length, the power of two at least twice the hop
+    inline size_t fftSize() const noexcept { return m_size; }
+
+private:
+
+    // Row (and weight of the next row) of every bin, row < 0 is silent
+    void mapBins(int height) noexcept;
+
+    // Target magnitudes of `frame`
+    void magnitudes(size_t frame, std::vector<double> &mag) const noexcept;
+
+    // Overlap-adds the frames with the current phases into m_signal
+    void synthesize() noexcept;
+
+    // Phases of the STFT of m_signal
+    void analyze() noexcept;
+
+    // Runs `func` over the frames such that frames running at the same time
+    // never overlap in the signal
+    void forFrames(const std::function<void(size_t frame, unsigned int worker)>
+                       &func) noexcept;
+
+    ThreadPool &m_pool;
+    Options m_options;
+    size_t m_size{ 0 }, m_bins{ 0 }, m_frames{ 0 };
+    const sonify::FFTPlan *m_plan{ nullptr };
+
+    const PixelStore *m_pixels{ nullptr };
+    std::vector<int> m_binRow;
+    std::vector<float> m_binFrac;
+    std::vector<double> m_window, m_norm, m_signal;
+    std::vector<float> m_phase; // m_frames * m_bins
+};
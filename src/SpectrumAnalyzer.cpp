@@ -0,0 +1,175 @@
+#include "SpectrumAnalyzer.hpp"
+
+#include "FFT.hpp"
+#include "raylib.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace
+{
+    constexpr double DB_RANGE  = 80.0; // dB shown below full scale
+    constexpr double MIN_FREQ  = 20.0;
+    constexpr double MAX_FREQ  = 20000.0;
+    constexpr double ATTACK    = 0.01; // seconds
+    constexpr double RELEASE   = 0.25;
+    constexpr double PEAK_HOLD = 0.6;
+    constexpr double PEAK_FALL = 1.0; // full height per second
+} // namespace
+
+SpectrumAnalyzer::~SpectrumAnalyzer() noexcept
+{
+    stop();
+}
+
+void
+SpectrumAnalyzer::start(const AudioTimeline &audio, float sampleRate,
+                        unsigned int channels) noexcept
+{
+    stop();
+
+    m_audio      = &audio;
+    m_sampleRate = sampleRate;
+    m_channels   = std::max(1u, channels);
+    m_frames     = (audio.size() / m_channels + HOP - 1) / HOP;
+    m_levels.assign(m_frames * BANDS, 0);
+    m_peaks.assign(m_frames * BANDS, 0);
+    bandEdges();
+
+    m_analyzed.store(0);
+    m_stop.store(false);
+    m_thread = std::thread([this]() { analyze(); });
+}
+
+void
+SpectrumAnalyzer::stop() noexcept
+{
+    m_stop.store(true);
+    if (m_thread.joinable()) m_thread.join();
+
+    m_audio  = nullptr;
+    m_frames = 0;
+    m_analyzed.store(0);
+    m_levels.clear();
+    m_peaks.clear();
+}
+
+void
+SpectrumAnalyzer::bandEdges() noexcept
+{
+    const double binHz = m_sampleRate / static_cast<double>(FFT_SIZE);
+    const double hi    = std::min(MAX_FREQ, m_sampleRate / 2.0);
+    const double lo    = std::min(MIN_FREQ, hi / 2.0);
+
+    // log spaced, but at least one bin per band
+    m_edges.resize(BANDS + 1);
+    size_t bin = std::max<size_t>(1, static_cast<size_t>(lo / binHz));
+    for (size_t b = 0; b <= BANDS; ++b)
+    {
+        const double f = lo * std::pow(hi / lo, b / static_cast<double>(BANDS));
+        bin = std::max(bin, static_cast<size_t>(std::lround(f / binHz)));
+        m_edges[b] = std::min(bin, FFT_SIZE / 2);
+        ++bin;
+    }
+}
+
+void
+SpectrumAnalyzer::analyze() noexcept
+{
+    const sonify::FFTPlan &plan = sonify::FFTPlan::get(FFT_SIZE);
+
+    std::vector<double> window(FFT_SIZE), samples(FFT_SIZE);
+    for (size_t i = 0; i < FFT_SIZE; ++i)
+        window[i] =
+            0.5 - 0.5 * std::cos(2.0 * std::numbers::pi * i / FFT_SIZE);
+
+    // magnitude of a full scale sine at the center of a bin
+    const double fullScale = 32767.0 * FFT_SIZE / 4.0;
+
+    const double hop     = HOP / static_cast<double>(m_sampleRate);
+    const double attack  = 1.0 - std::exp(-hop / ATTACK);
+    const double release = 1.0 - std::exp(-hop / RELEASE);
+    const size_t hold    = static_cast<size_t>(PEAK_HOLD / hop);
+    const double fall    = PEAK_FALL * hop;
+
+    const size_t C = m_channels;
+    std::vector<short> block(FFT_SIZE * C);
+    sonify::vec_complex spectrum(FFT_SIZE / 2 + 1);
+    double level[BANDS]{}, peak[BANDS]{};
+    size_t age[BANDS]{};
+
+    for (size_t f = 0; f < m_frames && !m_stop.load(); ++f)
+    {
+        // frame f is centered on audio frame f * HOP
+        const int64_t begin = static_cast<int64_t>(f * HOP) - FFT_SIZE / 2;
+        std::fill(block.begin(), block.end(), 0);
+        const size_t skip = begin < 0 ? static_cast<size_t>(-begin) : 0;
+        m_audio->read(static_cast<uint64_t>(begin + skip) * C,
+                      std::span<short>(block).subspan(skip * C));
+
+        for (size_t i = 0; i < FFT_SIZE; ++i)
+        {
+            double sum = 0.0;
+            for (size_t c = 0; c < C; ++c)
+                sum += block[i * C + c];
+            samples[i] = sum / C * window[i];
+        }
+        plan.forwardReal(samples, spectrum);
+
+        uint8_t *levels = m_levels.data() + f * BANDS;
+        uint8_t *peaks  = m_peaks.data() + f * BANDS;
+        for (size_t b = 0; b < BANDS; ++b)
+        {
+            // loudest bin of the band, in dB below full scale
+            const size_t last = std::max(m_edges[b + 1], m_edges[b] + 1);
+            double power      = 0.0;
+            for (size_t k = m_edges[b]; k < last; ++k)
+                power = std::max(power, std::norm(spectrum[k]));
+
+            const double db =
+                10.0 * std::log10(power / (fullScale * fullScale) + 1e-12);
+            const double target = std::clamp(1.0 + db / DB_RANGE, 0.0, 1.0);
+
+            level[b] += (target - level[b]) *
+                        (target > level[b] ? attack : release);
+
+            if (level[b] >= peak[b])
+            {
+                peak[b] = level[b];
+                age[b]  = 0;
+            }
+            else if (++age[b] > hold)
+                peak[b] = std::max(level[b], peak[b] - fall);
+
+            levels[b] = static_cast<uint8_t>(level[b] * 255.0 + 0.5);
+            peaks[b]  = static_cast<uint8_t>(peak[b] * 255.0 + 0.5);
+        }
+
+        m_analyzed.store(f + 1, std::memory_order_release);
+    }
+}
+
+void
+SpectrumAnalyzer::draw(uint64_t sample, int width, int baseY,
+                       int height) const noexcept
+{
+    const size_t f = static_cast<size_t>((sample / m_channels + HOP / 2) / HOP);
+    if (f >= analyzedFrames()) return;
+
+    const uint8_t *levels = m_levels.data() + f * BANDS;
+    const uint8_t *peaks  = m_peaks.data() + f * BANDS;
+    const float barWidth  = static_cast<float>(width) / BANDS;
+    const int bottom      = baseY + height;
+
+    for (size_t b = 0; b < BANDS; ++b)
+    {
+        const int x         = static_cast<int>(b * barWidth);
+        const int barHeight = levels[b] * height / 255;
+        const int peakY     = bottom - peaks[b] * height / 255;
+
+        DrawRectangle(x, bottom - barHeight, (int)(barWidth - 2), barHeight,
+                      BLUE);
+        DrawRectangle(x, peakY - 1, (int)(barWidth - 2), 2, SKYBLUE);
+    }
+}
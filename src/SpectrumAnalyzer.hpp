@@ -0,0 +1,63 @@
+#pragma once
+
+#include "AudioTimeline.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// Spectrum display data computed once per sonification instead of per frame.
+// A producer thread runs a Hann windowed, half overlapped FFT over the whole
+// timeline and reduces every frame to BANDS log spaced bands, smoothed over
+// time and with a peak that holds for a while before falling. The GUI only
+// looks up the frame of the playback position and draws it.
+class SpectrumAnalyzer
+{
+public:
+
+    static constexpr size_t BANDS    = 64;
+    static constexpr size_t FFT_SIZE = 2048;
+    static constexpr size_t HOP      = FFT_SIZE / 2;
+
+    SpectrumAnalyzer() = default;
+    ~SpectrumAnalyzer() noexcept;
+
+    // Starts analyzing `audio`, interleaved frames of `channels` samples
+    // mixed down to mono. `audio` must not change until stop() returns.
+    void start(const AudioTimeline &audio, float sampleRate,
+               unsigned int channels = 1) noexcept;
+
+    // Stops the producer and drops the frames
+    void stop() noexcept;
+
+    // Bars for the playback position `sample` (interleaved), `baseY` is the top of the
+    // `height` pixels tall area. Nothing is drawn before its frame is ready.
+    void draw(uint64_t sample, int width, int baseY, int height) const noexcept;
+
+    inline size_t frames() const noexcept { return m_frames; }
+    inline size_t analyzedFrames() const noexcept
+    {
+        return m_analyzed.load(std::memory_order_acquire);
+    }
+
+private:
+
+    void analyze() noexcept;
+
+    // First FFT bin of every band, BANDS + 1 edges
+    void bandEdges() noexcept;
+
+    const AudioTimeline *m_audio{ nullptr };
+    float m_sampleRate{ 44100.0f };
+    unsigned int m_channels{ 1 };
+    size_t m_frames{ 0 };
+    std::vector<size_t> m_edges;
+
+    // frames * BANDS levels and peaks, 0 to 255 over DB_RANGE dB
+    std::vector<uint8_t> m_levels, m_peaks;
+
+    std::atomic<size_t> m_analyzed{ 0 };
+    std::atomic<bool> m_stop{ false };
+    std::thread m_thread;
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Lock-free ring buffer for one producer thread and one consumer thread. The
+// indices only ever grow, the slot of index i is i & mask, so a full ring
+// and an empty one are told apart without a spare slot. Each side only
+// writes its own index; the other one is read with acquire ordering, which
+// makes the copied elements visible before the index that publishes them.
+template <typename T>
+class SpscRing
+{
+public:
+
+    explicit SpscRing(size_t capacity = 0) noexcept { resize(capacity); }
+
+    // Capacity rounded up to a power of two. Not thread safe, neither side
+    // may be running.
+    void resize(size_t capacity) noexcept
+    {
+        size_t size = 1;
+        while (size < capacity)
+            size <<= 1;
+
+        m_data.assign(size, T{});
+        m_mask = size - 1;
+        m_head.store(0);
+        m_tail.store(0);
+    }
+
+    inline size_t capacity() const noexcept { return m_data.size(); }
+
+    // Producer side
+
+    inline size_t writable() const noexcept
+    {
+        return capacity() - (m_head.load(std::memory_order_relaxed) -
+                             m_tail.load(std::memory_order_acquire));
+    }
+
+    // Index the next write() starts at
+    inline size_t writeIndex() const noexcept
+    {
+        return m_head.load(std::memory_order_relaxed);
+    }
+
+    // Copies as much of `in` as fits, returns the number of elements written
+    size_t write(std::span<const T> in) noexcept
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        const size_t n    = std::min(in.size(), writable());
+
+        const size_t at    = head & m_mask;
+        const size_t first = std::min(n, capacity() - at);
+        std::copy_n(in.data(), first, m_data.data() + at);
+        std::copy_n(in.data() + first, n - first, m_data.data());
+
+        m_head.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    // Consumer side
+
+    inline size_t readable() const noexcept
+    {
+        return m_head.load(std::memory_order_acquire) -
+               m_tail.load(std::memory_order_relaxed);
+    }
+
+    // Index the next read() starts at
+    inline size_t readIndex() const noexcept
+    {
+        return m_tail.load(std::memory_order_relaxed);
+    }
+
+    // Fills the start of `out` with what is available, returns the count
+    size_t read(std::span<T> out) noexcept
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t n    = std::min(out.size(), readable());
+
+        const size_t at    = tail & m_mask;
+        const size_t first = std::min(n, capacity() - at);
+        std::copy_n(m_data.data() + at, first, out.data());
+        std::copy_n(m_data.data(), n - first, out.data() + first);
+
+        m_tail.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    // Drops the elements before `index`, a writeIndex() of the producer
+    void skipTo(size_t index) noexcept
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (index - tail <= readable())
+            m_tail.store(index, std::memory_order_release);
+    }
+
+private:
+
+    std::vector<T> m_data;
+    size_t m_mask{ 0 };
+
+    // written by the producer and the consumer respectively, on separate
+    // cache lines so the two threads do not keep stealing them from another
+    alignas(64) std::atomic<size_t> m_head{ 0 };
+    alignas(64) std::atomic<size_t> m_tail{ 0 };
+};
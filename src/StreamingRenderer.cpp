@@ -0,0 +1,119 @@
+#include "StreamingRenderer.hpp"
+
+#include <algorithm>
+
+StreamingRenderer::StreamingRenderer(SonificationEngine &engine) noexcept
+    : m_engine(engine)
+{
+}
+
+StreamingRenderer::~StreamingRenderer() noexcept
+{
+    stop();
+}
+
+bool
+StreamingRenderer::start(SonificationEngine::Plan plan,
+                         AudioTimeline &audio) noexcept
+{
+    stop();
+
+    m_plan = std::move(plan);
+    m_out  = &audio;
+    if (!audio.allocate(m_plan.samples(), m_plan.offsets))
+    {
+        m_plan = SonificationEngine::Plan{};
+        m_ready.reset();
+        return false;
+    }
+
+    m_ready = std::make_unique<std::atomic<bool>[]>(m_plan.columns);
+    for (size_t i = 0; i < m_plan.columns; ++i)
+        m_ready[i].store(false, std::memory_order_relaxed);
+
+    m_rendered.store(0);
+    m_seekColumn.store(NO_SEEK);
+    m_stop.store(false);
+    m_running.store(true);
+
+    m_thread = std::thread([this]() { produce(); });
+    return true;
+}
+
+void
+StreamingRenderer::stop() noexcept
+{
+    m_stop.store(true);
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void
+StreamingRenderer::wait() noexcept
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]() { return finished() || !m_running.load(); });
+}
+
+void
+StreamingRenderer::seek(uint64_t sample) noexcept
+{
+    if (m_plan.columns == 0) return;
+    m_seekColumn.store(m_plan.columnAt(sample));
+}
+
+uint64_t
+StreamingRenderer::readyUntil(uint64_t sample, size_t want) const noexcept
+{
+    if (!m_ready || m_plan.columns == 0) return sample;
+
+    const uint64_t limit = sample + want;
+    size_t c           = m_plan.columnAt(sample);
+
+    while (c < m_plan.columns && m_ready[c].load(std::memory_order_acquire))
+    {
+        if (m_plan.offsets[c + 1] >= limit) return m_plan.offsets[c + 1];
+        ++c;
+    }
+
+    return std::max<uint64_t>(sample, m_plan.offsets[c]);
+}
+
+void
+StreamingRenderer::produce() noexcept
+{
+    // Small batches keep the first audio close to one buffer period away
+    const size_t batch = std::max<size_t>(4, 2 * m_engine.threads());
+    const size_t total = m_plan.columns;
+    size_t next        = 0;
+
+    while (!m_stop.load() && m_rendered.load() < total)
+    {
+        const size_t seekTo = m_seekColumn.exchange(NO_SEEK);
+        if (seekTo != NO_SEEK) next = seekTo;
+
+        // First column still missing from `next` on, wrapping around to
+        // pick up what a seek jumped over
+        size_t first = next;
+        while (m_ready[first].load(std::memory_order_relaxed))
+            first = (first + 1) % total;
+
+        size_t last = first;
+        while (last < total && last - first < batch &&
+               !m_ready[last].load(std::memory_order_relaxed))
+            ++last;
+
+        m_engine.renderRange(m_plan, first, last, *m_out);
+
+        for (size_t c = first; c < last; ++c)
+            m_ready[c].store(true, std::memory_order_release);
+
+        m_rendered.fetch_add(last - first);
+        next = last % total;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running.store(false);
+    }
+    m_done.notify_all();
+}
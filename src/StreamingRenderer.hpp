@@ -0,0 +1,70 @@
+#pragma once
+
+#include "SonificationEngine.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Renders a plan into a preallocated timeline on a producer thread, a few
+// columns at a time starting from the playback position, so that playback can
+// start as soon as the first columns are ready. Columns skipped by a seek are
+// filled in once the producer reaches the end of the timeline.
+class StreamingRenderer
+{
+public:
+
+    explicit StreamingRenderer(SonificationEngine &engine) noexcept;
+    ~StreamingRenderer() noexcept;
+
+    // Sizes `audio` for the whole plan (silence) and starts rendering into it.
+    // `audio` must not be touched by anyone else until stop() returns.
+    bool start(SonificationEngine::Plan plan, AudioTimeline &audio) noexcept;
+
+    // Stops the producer, leaving the columns rendered so far in place
+    void stop() noexcept;
+
+    // Blocks until every column is rendered
+    void wait() noexcept;
+
+    // Makes the producer continue from the column containing `sample`
+    void seek(uint64_t sample) noexcept;
+
+    // End of the run of rendered samples starting at `sample`, looking at
+    // most `want` samples ahead. Safe to call from the audio thread.
+    uint64_t readyUntil(uint64_t sample, size_t want) const noexcept;
+
+    inline bool active() const noexcept { return m_thread.joinable(); }
+    inline size_t columns() const noexcept { return m_plan.columns; }
+    inline size_t renderedColumns() const noexcept
+    {
+        return m_rendered.load(std::memory_order_relaxed);
+    }
+    inline bool finished() const noexcept
+    {
+        return renderedColumns() == m_plan.columns;
+    }
+
+private:
+
+    void produce() noexcept;
+
+    static constexpr size_t NO_SEEK = static_cast<size_t>(-1);
+
+    SonificationEngine &m_engine;
+    SonificationEngine::Plan m_plan;
+    AudioTimeline *m_out{ nullptr };
+
+    std::unique_ptr<std::atomic<bool>[]> m_ready;
+    std::atomic<size_t> m_rendered{ 0 };
+    std::atomic<size_t> m_seekColumn{ NO_SEEK };
+    std::atomic<bool> m_stop{ false };
+    std::atomic<bool> m_running{ false };
+
+    std::mutex m_mutex;
+    std::condition_variable m_done;
+    std::thread m_thread;
+};
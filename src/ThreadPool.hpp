@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed size worker pool. `parallelFor` hands out indices dynamically to the
+// calling thread and the workers, so a blocked caller never waits on work that
+// no worker has picked up yet (safe to nest from inside a task).
+class ThreadPool
+{
+public:
+
+    using Task    = std::function<void()>;
+    using ForFunc = std::function<void(size_t index, unsigned int worker)>;
+
+    // threads = 0 picks the hardware concurrency
+    explicit ThreadPool(unsigned int threads = 0) noexcept
+    {
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+
+        m_size = threads;
+
+        // the calling thread takes part in `parallelFor`, so one less worker
+        for (unsigned int i = 1; i < threads; ++i)
+            m_workers.emplace_back([this]() { workerLoop(); });
+    }
+
+    ~ThreadPool() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+
+        for (auto &t : m_workers)
+            if (t.joinable()) t.join();
+    }
+
+    ThreadPool(const ThreadPool &)            = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Number of threads taking part in `parallelFor` (workers + caller)
+    inline unsigned int size() const noexcept { return m_size; }
+
+    // Queue a task on the workers. With a pool of size 1 the task runs inline.
+    void submit(Task task) noexcept
+    {
+        if (m_workers.empty())
+        {
+            task();
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+        }
+        m_cv.notify_one();
+    }
+
+    // Calls fn(i, worker) for every i in [0, count) and blocks until all the
+    // calls returned. `worker` is in [0, size()) and is unique among the
+    // threads running concurrently, so it can index per thread scratch data.
+    void parallelFor(size_t count, const ForFunc &fn) noexcept
+    {
+        if (count == 0) return;
+
+        if (m_workers.empty() || count == 1)
+        {
+            for (size_t i = 0; i < count; ++i)
+                fn(i, 0);
+            return;
+        }
+
+        struct State
+        {
+            std::atomic<size_t> next{ 0 };
+            std::mutex mutex;
+            std::condition_variable done;
+            unsigned int started{ 0 }, finished{ 0 };
+            bool closed{ false };
+        };
+
+        auto state = std::make_shared<State>();
+
+        auto drain = [state, count, &fn](unsigned int worker)
+        {
+            for (size_t i = state->next.fetch_add(1); i < count;
+                 i         = state->next.fetch_add(1))
+                fn(i, worker);
+        };
+
+        const unsigned int helpers = static_cast<unsigned int>(
+            std::min<size_t>(m_workers.size(), count - 1));
+
+        for (unsigned int h = 1; h <= helpers; ++h)
+        {
+            submit([state, drain, h]()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    if (state->closed) return;
+                    state->started++;
+                }
+
+                drain(h);
+
+                {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    state->finished++;
+                }
+                state->done.notify_one();
+            });
+        }
+
+        drain(0);
+
+        // Helpers that did not start yet will see `closed` and bail out, so
+        // only wait for the ones that are actually running.
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->closed = true;
+        state->done.wait(lock, [&state]()
+        { return state->finished == state->started; });
+    }
+
+private:
+
+    void workerLoop() noexcept
+    {
+        while (true)
+        {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+                if (m_stop && m_tasks.empty()) return;
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    unsigned int m_size{ 1 };
+    std::vector<std::thread> m_workers;
+    std::deque<Task> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop{ false };
+};
@@ -0,0 +1,281 @@
+#include "VideoRenderer.hpp"
+
+#include "FrameWriter.hpp"
+#include "ffmpeg.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <csignal>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+    inline unsigned char blend(unsigned char fg, unsigned char bg,
+                               unsigned char a) noexcept
+    {
+        return static_cast<unsigned char>((fg * a + bg * (255 - a) + 127) /
+                                          255);
+    }
+} // namespace
+
+VideoRenderer::VideoRenderer(ThreadPool &pool, const Options &options) noexcept
+    : m_pool(pool), m_options(options)
+{
+    m_options.fps       = std::max(1u, m_options.fps);
+    m_options.channels  = std::max(1u, m_options.channels);
+    m_options.thickness = std::max(1, m_options.thickness);
+}
+
+void
+VideoRenderer::compose(const PixelStore &pixels,
+                       TraversalType traversal) noexcept
+{
+    m_traversal = traversal;
+    m_imageW    = pixels.width();
+    m_imageH    = pixels.height();
+    m_width     = (m_imageW + 1) & ~1;
+    m_height    = (m_imageH + 1) & ~1;
+
+    const Color bg = m_options.background;
+    m_base.assign(static_cast<size_t>(m_width) * m_height, bg);
+
+    const Color *src = pixels.rows();
+    for (int y = 0; y < m_imageH; ++y)
+    {
+        Color *row = m_base.data() + static_cast<size_t>(y) * m_width;
+        for (int x = 0; x < m_imageW; ++x)
+        {
+            const Color c = src[static_cast<size_t>(y) * m_imageW + x];
+            row[x]        = { blend(c.r, bg.r, c.a), blend(c.g, bg.g, c.a),
+                              blend(c.b, bg.b, c.a), 255 };
+        }
+    }
+}
+
+void
+VideoRenderer::fillRect(Color *frame, int x0, int y0, int x1,
+                        int y1) const noexcept
+{
+    x0 = std::clamp(x0, 0, m_imageW);
+    x1 = std::clamp(x1, 0, m_imageW);
+    y0 = std::clamp(y0, 0, m_imageH);
+    y1 = std::clamp(y1, 0, m_imageH);
+
+    for (int y = y0; y < y1; ++y)
+        std::fill(frame + static_cast<size_t>(y) * m_width + x0,
+                  frame + static_cast<size_t>(y) * m_width + x1,
+                  m_options.cursor);
+}
+
+void
+VideoRenderer::drawRing(Color *frame, float radius) const noexcept
+{
+    const float cx   = m_imageW / 2.0f;
+    const float cy   = m_imageH / 2.0f;
+    const float half = m_options.thickness / 2.0f;
+    const float r0   = std::max(0.0f, radius - half);
+    const float r1   = radius + half;
+
+    const int y0 = std::max(0, static_cast<int>(std::floor(cy - r1)));
+    const int y1 = std::min(m_imageH, static_cast<int>(std::ceil(cy + r1)));
+
+    for (int y = y0; y < y1; ++y)
+    {
+        const float dy = y + 0.5f - cy;
+        if (std::fabs(dy) > r1) continue;
+
+        // the row crosses the ring in up to two spans, each side of cx
+        const float outer = std::sqrt(r1 * r1 - dy * dy);
+        const float inner =
+            std::fabs(dy) < r0 ? std::sqrt(r0 * r0 - dy * dy) : 0.0f;
+
+        Color *row = frame + static_cast<size_t>(y) * m_width;
+        auto span  = [&](float a, float b)
+        {
+            const int xa = std::clamp(static_cast<int>(std::lround(a)), 0,
+                                      m_imageW);
+            const int xb = std::clamp(static_cast<int>(std::lround(b)), 0,
+                                      m_imageW);
+            std::fill(row + xa, row + std::max(xa, xb), m_options.cursor);
+        };
+
+        span(cx - outer, cx - inner);
+        span(cx + inner, cx + outer);
+    }
+}
+
+void
+VideoRenderer::drawRay(Color *frame, float angle) const noexcept
+{
+    // Ray from the center, `angle` degrees clockwise on screen from +x, like
+    // the rows of PolarGrid
+    const float cx   = m_imageW / 2.0f;
+    const float cy   = m_imageH / 2.0f;
+    const float rad  = angle * static_cast<float>(M_PI) / 180.0f;
+    const float dx   = std::cos(rad);
+    const float dy   = std::sin(rad);
+    const float len  = std::sqrt(cx * cx + cy * cy);
+    const float half = m_options.thickness / 2.0f;
+
+    for (int y = 0; y < m_imageH; ++y)
+    {
+        Color *row     = frame + static_cast<size_t>(y) * m_width;
+        const float py = y + 0.5f - cy;
+
+        for (int x = 0; x < m_imageW; ++x)
+        {
+            const float px    = x + 0.5f - cx;
+            const float along = px * dx + py * dy;
+            if (along < 0.0f || along > len) continue;
+            if (std::fabs(px * dy - py * dx) <= half) row[x] = m_options.cursor;
+        }
+    }
+}
+
+void
+VideoRenderer::frame(float progress, Color *out) const noexcept
+{
+    std::memcpy(out, m_base.data(), m_base.size() * sizeof(Color));
+    progress = std::clamp(progress, 0.0f, 1.0f);
+
+    Color *f    = out;
+    const int t = m_options.thickness;
+    const int w = m_imageW, h = m_imageH;
+
+    // Same cursor geometry as the GUI (Sonify::updateCursorUpdater)
+    switch (m_traversal)
+    {
+        case TraversalType::LEFT_TO_RIGHT:
+        {
+            const int x = static_cast<int>(std::ceil(progress * w));
+            fillRect(f, x, 0, x + t, h);
+            break;
+        }
+
+        case TraversalType::RIGHT_TO_LEFT:
+        {
+            const int x = static_cast<int>(w - progress * w);
+            fillRect(f, x, 0, x + t, h);
+            break;
+        }
+
+        case TraversalType::TOP_TO_BOTTOM:
+        {
+            const int y = static_cast<int>(progress * h);
+            fillRect(f, 0, y, w, y + t);
+            break;
+        }
+
+        case TraversalType::BOTTOM_TO_TOP:
+        {
+            const int y = static_cast<int>(h - progress * h);
+            fillRect(f, 0, y, w, y + t);
+            break;
+        }
+
+        case TraversalType::CIRCLE_INWARDS:
+        case TraversalType::CIRCLE_OUTWARDS:
+        {
+            const float maxr = std::sqrt(w * w / 4.0f + h * h / 4.0f);
+            const float r    = m_traversal == TraversalType::CIRCLE_INWARDS
+                                   ? maxr - progress * maxr
+                                   : progress * maxr;
+            drawRing(f, r);
+            break;
+        }
+
+        case TraversalType::CLOCKWISE: drawRay(f, progress * 360.0f); break;
+
+        case TraversalType::ANTICLOCKWISE:
+            drawRay(f, -progress * 360.0f);
+            break;
+
+        case TraversalType::PATH:
+        case TraversalType::REGION: break;
+    }
+}
+
+bool
+VideoRenderer::render(const PixelStore &pixels, TraversalType traversal,
+                      const AudioTimeline &audio,
+                      const std::string &outPath) noexcept
+{
+    if (pixels.empty() || audio.empty()) return false;
+
+    compose(pixels, traversal);
+
+    const double samplesPerFrame =
+        static_cast<double>(m_options.sampleRate) * m_options.channels /
+        m_options.fps;
+    const size_t frames = static_cast<size_t>(
+        std::ceil(static_cast<double>(audio.size()) / samplesPerFrame));
+
+    FFmpegPipes pipes;
+    if (!ffmpeg_video_audio_pipes(m_width, m_height, m_options.fps,
+                                  m_options.sampleRate, m_options.channels,
+                                  outPath.c_str(), pipes))
+    {
+        TraceLog(LOG_ERROR, "Unable to start ffmpeg");
+        return false;
+    }
+
+    // a dead encoder must fail the writes, not kill the process
+    auto previous = std::signal(SIGPIPE, SIG_IGN);
+
+    // ffmpeg reads both inputs as it goes, feed the audio from its own thread
+    bool audioOk = true;
+    std::thread audioWriter([&]()
+    {
+        for (size_t i = 0; i < audio.chunks() && audioOk; ++i)
+        {
+            const auto chunk = audio.chunk(i);
+            audioOk = std::fwrite(chunk.data(), sizeof(short), chunk.size(),
+                                  pipes.audio) == chunk.size();
+        }
+        audioOk = std::fclose(pipes.audio) == 0 && audioOk;
+        pipes.audio = nullptr;
+    });
+
+    const size_t frameBytes = m_base.size() * sizeof(Color);
+    const size_t batch      = std::max<size_t>(2, 2 * m_pool.size());
+
+    FrameWriter writer(batch);
+    writer.start(pipes.video, frameBytes);
+
+    std::vector<FrameWriter::Buffer> rendered(batch);
+
+    for (size_t first = 0; first < frames; first += batch)
+    {
+        const size_t count = std::min(batch, frames - first);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            rendered[i] = writer.acquire();
+            rendered[i].resize(frameBytes);
+        }
+
+        // timestamp n / fps is sample n * samplesPerFrame of the timeline
+        m_pool.parallelFor(count, [&](size_t i, unsigned int)
+        {
+            const double sample = (first + i) * samplesPerFrame;
+            frame(static_cast<float>(sample / audio.size()),
+                  reinterpret_cast<Color *>(rendered[i].data()));
+        });
+
+        for (size_t i = 0; i < count; ++i)
+            writer.submit(std::move(rendered[i]));
+    }
+
+    // end of the video input, ffmpeg may be waiting for it to read the audio
+    bool videoOk = writer.finish();
+    videoOk      = std::fclose(pipes.video) == 0 && videoOk;
+    pipes.video  = nullptr;
+    audioWriter.join();
+
+    const bool ok = ffmpeg_wait(pipes) && videoOk && audioOk;
+    std::signal(SIGPIPE, previous);
+
+    if (!ok) TraceLog(LOG_ERROR, "Video export to %s failed", outPath.c_str());
+    return ok;
+}
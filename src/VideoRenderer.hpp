@@ -0,0 +1,56 @@
+#pragma once
+
+#include "PixelStore.hpp"
+#include "SonificationEngine.hpp"
+#include "ThreadPool.hpp"
+#include "raylib.h"
+
+#include <string>
+#include <vector>
+
+// Offline video export: every frame is composed on the CPU (the image plus the
+// traversal cursor at timestamp n / fps) with frames rendered in parallel, and
+// streamed to ffmpeg together with the audio through a second pipe. Needs no
+// window or GL context and runs as fast as the encoder takes frames.
+class VideoRenderer
+{
+public:
+
+    struct Options
+    {
+        unsigned int fps{ 30 };
+        unsigned int sampleRate{ 44100 }, channels{ 1 };
+        Color background{ BLACK }, cursor{ RED };
+        int thickness{ 1 };
+    };
+
+    VideoRenderer(ThreadPool &pool, const Options &options) noexcept;
+
+    bool render(const PixelStore &pixels, TraversalType traversal,
+                const AudioTimeline &audio,
+                const std::string &outPath) noexcept;
+
+    // Frame size, the image rounded up to even dimensions for yuv420p
+    inline int width() const noexcept { return m_width; }
+    inline int height() const noexcept { return m_height; }
+
+    // Frame at `progress` (0 to 1) of the traversal into `out`, width() *
+    // height() pixels. compose() must have been called first.
+    void frame(float progress, Color *out) const noexcept;
+
+    // Image over the background, the part of every frame that never changes
+    void compose(const PixelStore &pixels, TraversalType traversal) noexcept;
+
+private:
+
+    void fillRect(Color *frame, int x0, int y0, int x1, int y1) const noexcept;
+    void drawRing(Color *frame, float radius) const noexcept;
+    void drawRay(Color *frame, float angle) const noexcept;
+
+    ThreadPool &m_pool;
+    Options m_options;
+    TraversalType m_traversal{ TraversalType::LEFT_TO_RIGHT };
+    int m_imageW{ 0 }, m_imageH{ 0 };
+    int m_width{ 0 }, m_height{ 0 };
+    std::vector<Color> m_base;
+};
@@ -0,0 +1,181 @@
+#include "WavWriter.hpp"
+
+#include "raylib.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    inline void putLE(unsigned char *p, uint64_t v, int bytes) noexcept
+    {
+        for (int i = 0; i < bytes; ++i)
+            p[i] = static_cast<unsigned char>(v >> (8 * i));
+    }
+
+    // RIFF header, a JUNK chunk reserving room for the ds64 chunk of RF64,
+    // fmt and, for float data, fact. The data chunk header follows.
+    constexpr size_t JUNK_SIZE = 28;
+    constexpr uint32_t UNKNOWN = UINT32_MAX; // size of a streamed chunk
+} // namespace
+
+WavWriter::~WavWriter() noexcept
+{
+    close();
+}
+
+bool
+WavWriter::parseFormat(const std::string &name, Format &format) noexcept
+{
+    if (name == "s16") format = Format::PCM16;
+    else if (name == "s24") format = Format::PCM24;
+    else if (name == "f32") format = Format::FLOAT32;
+    else return false;
+
+    return true;
+}
+
+bool
+WavWriter::open(const std::string &path, unsigned int sampleRate,
+                unsigned int channels, Format format) noexcept
+{
+    close();
+
+    m_stdout = path == "-";
+    m_file   = m_stdout ? stdout : std::fopen(path.c_str(), "wb");
+    if (!m_file)
+    {
+        TraceLog(LOG_ERROR, "Unable to open %s for writing", path.c_str());
+        return false;
+    }
+
+    // large writes go straight through, small ones are gathered
+    if (!m_stdout) std::setvbuf(m_file, nullptr, _IOFBF, 1 << 20);
+
+    m_format     = format;
+    m_sampleRate = sampleRate;
+    m_channels   = std::max(1u, channels);
+    m_samples    = 0;
+
+    // placeholder sizes until close()
+    return writeHeader();
+}
+
+bool
+WavWriter::write(std::span<const short> samples) noexcept
+{
+    if (!m_file) return false;
+
+    // WAV samples are little endian, as is every platform this runs on
+    const void *data = samples.data();
+    const size_t n   = samples.size();
+    const size_t bps = bytesPerSample();
+
+    if (m_format == Format::PCM24)
+    {
+        // 16 bit samples in the upper two bytes
+        m_convert.resize(n * 3);
+        unsigned char *p = m_convert.data();
+        for (size_t i = 0; i < n; ++i, p += 3)
+            putLE(p, static_cast<uint32_t>(samples[i]) << 8, 3);
+        data = m_convert.data();
+    }
+    else if (m_format == Format::FLOAT32)
+    {
+        m_convert.resize(n * sizeof(float));
+        auto *p = reinterpret_cast<float *>(m_convert.data());
+        for (size_t i = 0; i < n; ++i)
+            p[i] = samples[i] / 32768.0f;
+        data = m_convert.data();
+    }
+
+    if (std::fwrite(data, bps, n, m_file) != n)
+    {
+        TraceLog(LOG_ERROR, "Unable to write audio samples");
+        return false;
+    }
+
+    m_samples += n;
+    return true;
+}
+
+bool
+WavWriter::close() noexcept
+{
+    if (!m_file) return true;
+
+    // chunks are padded to an even length, 24 bit data may be odd
+    bool ok = (m_samples * bytesPerSample()) % 2 == 0 ||
+              std::fputc(0, m_file) != EOF;
+    if (m_stdout) ok = std::fflush(m_file) == 0 && ok;
+    else
+    {
+        ok = std::fseek(m_file, 0, SEEK_SET) == 0 && writeHeader() && ok;
+        ok = std::fclose(m_file) == 0 && ok;
+    }
+
+    m_file = nullptr;
+    m_convert.clear();
+    m_convert.shrink_to_fit();
+
+    return ok;
+}
+
+bool
+WavWriter::writeHeader() noexcept
+{
+    const bool isFloat   = m_format == Format::FLOAT32;
+    const uint32_t fmt   = isFloat ? 18 : 16;
+    const size_t header  = 12 + (8 + JUNK_SIZE) + (8 + fmt) +
+                          (isFloat ? 12 : 0) + 8;
+    const uint64_t data  = m_samples * bytesPerSample();
+    const uint64_t riff  = header - 8 + data + data % 2; // pad byte
+    const uint64_t count = frames();
+
+    // RF64 once any 32 bit size overflows; streams never know their size
+    const bool rf64 = !m_stdout && riff > UINT32_MAX;
+    auto size32     = [this, rf64](uint64_t v) -> uint32_t
+    { return m_stdout || rf64 ? UNKNOWN : static_cast<uint32_t>(v); };
+
+    unsigned char h[12 + 8 + JUNK_SIZE + 8 + 18 + 12 + 8] = {};
+    unsigned char *p = h;
+
+    std::memcpy(p, rf64 ? "RF64" : "RIFF", 4);
+    putLE(p + 4, size32(riff), 4);
+    std::memcpy(p + 8, "WAVE", 4);
+    p += 12;
+
+    std::memcpy(p, rf64 ? "ds64" : "JUNK", 4);
+    putLE(p + 4, JUNK_SIZE, 4);
+    if (rf64)
+    {
+        putLE(p + 8, riff, 8);
+        putLE(p + 16, data, 8);
+        putLE(p + 24, count, 8);
+        // no table entries
+    }
+    p += 8 + JUNK_SIZE;
+
+    std::memcpy(p, "fmt ", 4);
+    putLE(p + 4, fmt, 4);
+    putLE(p + 8, isFloat ? 3 : 1, 2); // IEEE float or PCM
+    putLE(p + 10, m_channels, 2);
+    putLE(p + 12, m_sampleRate, 4);
+    putLE(p + 16, m_sampleRate * m_channels * bytesPerSample(), 4);
+    putLE(p + 20, m_channels * bytesPerSample(), 2); // block align
+    putLE(p + 22, 8 * bytesPerSample(), 2);          // bits per sample
+    p += 8 + fmt; // cbSize of float is 0
+
+    if (isFloat)
+    {
+        std::memcpy(p, "fact", 4);
+        putLE(p + 4, 4, 4);
+        putLE(p + 8, size32(count), 4);
+        p += 12;
+    }
+
+    std::memcpy(p, "data", 4);
+    putLE(p + 4, size32(data), 4);
+
+    return std::fwrite(h, 1, header, m_file) == header;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <vector>
+
+// Writes a WAV file as samples come in, so the whole audio never has to be in
+// memory. The sizes in the header are filled in by close(); a file that grows
+// past 4 GiB is turned into RF64 at that point. The path "-" writes to stdout,
+// where the header cannot be patched and announces the largest sizes instead,
+// which sox and ffmpeg read as "until the end of the stream".
+class WavWriter
+{
+public:
+
+    enum class Format
+    {
+        PCM16 = 0,
+        PCM24,
+        FLOAT32
+    };
+
+    WavWriter() = default;
+    ~WavWriter() noexcept;
+
+    WavWriter(const WavWriter &)            = delete;
+    WavWriter &operator=(const WavWriter &) = delete;
+
+    bool open(const std::string &path, unsigned int sampleRate,
+              unsigned int channels, Format format = Format::PCM16) noexcept;
+
+    // Appends interleaved samples, converted to the format of the file
+    bool write(std::span<const short> samples) noexcept;
+
+    bool close() noexcept;
+
+    inline uint64_t frames() const noexcept
+    {
+        return m_channels ? m_samples / m_channels : 0;
+    }
+
+    inline bool isOpen() const noexcept { return m_file != nullptr; }
+
+    // "s16", "s24" or "f32"
+    static bool parseFormat(const std::string &name, Format &format) noexcept;
+
+private:
+
+    bool writeHeader() noexcept;
+
+    inline unsigned int bytesPerSample() const noexcept
+    {
+        return m_format == Format::PCM16 ? 2 : m_format == Format::PCM24 ? 3
+                                                                         : 4;
+    }
+
+    std::FILE *m_file{ nullptr };
+    bool m_stdout{ false };
+    Format m_format{ Format::PCM16 };
+    unsigned int m_sampleRate{ 0 }, m_channels{ 0 };
+    uint64_t m_samples{ 0 };
+    std::vector<unsigned char> m_convert; // a block in the file format
+};
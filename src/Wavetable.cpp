@@ -0,0 +1,153 @@
+#include "sonify/Wavetable.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Highest harmonic of level 0
+    constexpr uint32_t HARMONICS = 1024;
+    static_assert(HARMONICS < Wavetable::SIZE / 2);
+} // namespace
+
+const Wavetable &
+Wavetable::get(utils::WaveType type) noexcept
+{
+    // built once, thread safe
+    static const Wavetable sine(utils::WaveType::SINE);
+    static const Wavetable square(utils::WaveType::SQUARE);
+    static const Wavetable sawtooth(utils::WaveType::SAWTOOTH);
+    static const Wavetable triangle(utils::WaveType::TRIANGLE);
+
+    switch (type)
+    {
+        case utils::WaveType::SQUARE: return square;
+        case utils::WaveType::SAWTOOTH: return sawtooth;
+        case utils::WaveType::TRIANGLE: return triangle;
+        case utils::WaveType::SINE: break;
+    }
+
+    return sine;
+}
+
+void
+Wavetable::prepare() noexcept
+{
+    get(utils::WaveType::SINE);
+}
+
+Wavetable::Wavetable(utils::WaveType type) noexcept
+    : m_tables(static_cast<size_t>(LEVELS) * (SIZE + 1))
+{
+    constexpr uint32_t MASK = SIZE - 1;
+
+    // sin(n * 2 pi j / SIZE) is entry (n * j) mod SIZE of one sine cycle, so
+    // the series needs no trigonometry beyond this table
+    std::vector<double> sine(SIZE);
+    for (uint32_t j = 0; j < SIZE; ++j)
+        sine[j] = std::sin(2.0 * M_PI * j / SIZE);
+
+    // Fourier series matching utils::squareAt, sawtoothAt and triangleAt
+    auto coefficient = [type](uint32_t n, bool &cosine) -> double
+    {
+        cosine = false;
+        switch (type)
+        {
+            case utils::WaveType::SINE: return n == 1 ? 1.0 : 0.0;
+            case utils::WaveType::SQUARE:
+                return n % 2 ? 4.0 / (M_PI * n) : 0.0;
+            case utils::WaveType::SAWTOOTH: return -2.0 / (M_PI * n);
+            case utils::WaveType::TRIANGLE:
+                cosine = true;
+                return n % 2 ? 8.0 / (M_PI * M_PI * n * n) : 0.0;
+        }
+        return 0.0;
+    };
+
+    // From the poorest level up, each one adding the harmonics it has on top
+    // of the previous one
+    std::vector<double> sum(SIZE, 0.0);
+    uint32_t harmonics = 0;
+    for (int k = LEVELS - 1; k >= 0; --k)
+    {
+        const uint32_t top = HARMONICS >> k;
+        for (uint32_t n = harmonics + 1; n <= top; ++n)
+        {
+            bool cosine;
+            const double a = coefficient(n, cosine);
+            if (a == 0.0) continue;
+
+            const uint32_t shift = cosine ? SIZE / 4 : 0;
+            for (uint32_t j = 0; j < SIZE; ++j)
+                sum[j] += a * sine[(n * j + shift) & MASK];
+        }
+        harmonics = top;
+
+        float *table = m_tables.data() + static_cast<size_t>(k) * (SIZE + 1);
+        for (uint32_t j = 0; j < SIZE; ++j)
+            table[j] = static_cast<float>(sum[j]);
+        table[SIZE] = table[0];
+    }
+}
+
+const float *
+Wavetable::level(double cycles) const noexcept
+{
+    // harmonic n of the level is at n * cycles, below 0.5 to be safe
+    const double limit = 0.5 / std::max(cycles, 1e-12);
+    if (limit < 1.0) return nullptr;
+
+    int k = 0;
+    while (k < LEVELS - 1 && (HARMONICS >> k) > limit)
+        ++k;
+
+    return m_tables.data() + static_cast<size_t>(k) * (SIZE + 1);
+}
+
+WavetableOscillator::WavetableOscillator(utils::WaveType type,
+                                         float sampleRate) noexcept
+    : m_wave(Wavetable::get(type)), m_sampleRate(sampleRate)
+{
+}
+
+void
+WavetableOscillator::set(double freq, float amp) noexcept
+{
+    const double cycles = std::fabs(freq) / m_sampleRate;
+    const double turns  = cycles - std::floor(cycles);
+
+    m_amp   = amp;
+    m_inc   = static_cast<uint32_t>(static_cast<uint64_t>(turns * 4294967296.0));
+    m_table = m_wave.level(cycles);
+}
+
+void
+WavetableOscillator::render(std::span<float> out) noexcept
+{
+    if (!m_table)
+    {
+        // above Nyquist: silence rather than an alias
+        std::fill(out.begin(), out.end(), 0.0f);
+        m_phase += static_cast<uint32_t>(out.size()) * m_inc;
+        return;
+    }
+
+    uint32_t phase = m_phase;
+    for (float &s : out)
+    {
+        s = m_amp * Wavetable::lookup(m_table, phase);
+        phase += m_inc;
+    }
+    m_phase = phase;
+}
+
+void
+WavetableOscillator::render(std::span<short> out) noexcept
+{
+    m_mix.resize(out.size());
+    render(std::span<float>(m_mix));
+
+    for (size_t i = 0; i < out.size(); ++i)
+        out[i] = static_cast<short>(
+            std::min(1.0f, std::max(-1.0f, m_mix[i])) * 32767.0f);
+}
@@ -2,28 +2,122 @@
 
 #include <cstdio>
 #include <format>
+#include <string>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
 
-FILE *
-ffmpeg_audio_video(int w, int h, unsigned int fps, const char *audioPath,
-                   const char *outPath) noexcept
+bool
+ffmpeg_video_audio_pipes(int w, int h, unsigned int fps,
+                         unsigned int sampleRate, unsigned int channels,
+                         const char *outPath, FFmpegPipes &pipes,
+                         bool flip) noexcept
 {
-    std::string cmd;
-    cmd = std::format("ffmpeg -loglevel verbose -y "
-                      "-f rawvideo -pix_fmt rgba -s {}x{} -r {} -i - "
-                      "-i '{}' "
-                      "-c:v libx264 -pix_fmt yuv420p "
-                      "-c:a aac "
-                      "'{}'",
-                      w, h, fps, audioPath, outPath);
-
-    FILE *pipe = popen(cmd.c_str(), "w");
-
-    if (!pipe)
+    int video[2], audio[2];
+    if (pipe(video) != 0) return false;
+    if (pipe(audio) != 0)
     {
-        std::perror("popen ffmpeg");
-        return nullptr;
+        close(video[0]);
+        close(video[1]);
+        return false;
     }
 
-    setvbuf(pipe, nullptr, _IONBF, 0);
-    return pipe;
+    std::vector<std::string> args = {
+        "ffmpeg",
+        "-loglevel",
+        "error",
+        "-y",
+        "-f",
+        "rawvideo",
+        "-pix_fmt",
+        "rgba",
+        "-s",
+        std::format("{}x{}", w, h),
+        "-r",
+        std::to_string(fps),
+        "-i",
+        "pipe:0",
+        "-f",
+        "s16le",
+        "-ar",
+        std::to_string(sampleRate),
+        "-ac",
+        std::to_string(channels),
+        "-i",
+        "pipe:3",
+    };
+    if (flip) args.insert(args.end(), { "-vf", "vflip" });
+    args.insert(args.end(), {
+        "-c:v",
+        "libx264",
+        "-pix_fmt",
+        "yuv420p",
+        "-c:a",
+        "aac",
+        outPath,
+    });
+
+    std::vector<char *> argv;
+    for (const auto &a : args)
+        argv.push_back(const_cast<char *>(a.c_str()));
+    argv.push_back(nullptr);
+
+    const pid_t pid = fork();
+    if (pid < 0)
+    {
+        std::perror("fork ffmpeg");
+        for (int fd : { video[0], video[1], audio[0], audio[1] })
+            close(fd);
+        return false;
+    }
+
+    if (pid == 0)
+    {
+        // frames on stdin, samples on fd 3. Move the audio end out of the
+        // way first in case pipe() handed out fd 0.
+        const int a = fcntl(audio[0], F_DUPFD, 4);
+        dup2(video[0], 0);
+        dup2(a, 3);
+        for (int fd : { video[0], video[1], audio[0], audio[1], a })
+            if (fd > 3) close(fd);
+
+        execvp("ffmpeg", argv.data());
+        std::perror("exec ffmpeg");
+        _exit(127);
+    }
+
+    close(video[0]);
+    close(audio[0]);
+
+    pipes.pid   = pid;
+    pipes.video = fdopen(video[1], "wb");
+    pipes.audio = fdopen(audio[1], "wb");
+
+    if (!pipes.video || !pipes.audio)
+    {
+        ffmpeg_wait(pipes);
+        return false;
+    }
+
+    setvbuf(pipes.video, nullptr, _IOFBF, 1 << 20);
+    return true;
+}
+
+bool
+ffmpeg_wait(FFmpegPipes &pipes) noexcept
+{
+    if (pipes.video) fclose(pipes.video);
+    if (pipes.audio) fclose(pipes.audio);
+    pipes.video = pipes.audio = nullptr;
+
+    if (pipes.pid <= 0) return false;
+
+    int status = 0;
+    while (waitpid(pipes.pid, &status, 0) < 0 && errno == EINTR)
+        ;
+    pipes.pid = -1;
+
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
 }
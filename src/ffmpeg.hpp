@@ -1,7 +1,26 @@
 #pragma once
 
 #include <cstdio>
+#include <sys/types.h>
 
-FILE *
-ffmpeg_audio_video(int w, int h, unsigned int fps, const char *audioPath,
-                   const char *outPath) noexcept;
+// Encoder spawned with two input pipes: raw RGBA frames on `video` (its
+// stdin) and interleaved s16le samples on `audio` (its fd 3), so nothing goes
+// through a temporary file. With `flip` the frames are stored bottom row
+// first (OpenGL readback order) and ffmpeg turns them upright.
+struct FFmpegPipes
+{
+    FILE *video{ nullptr };
+    FILE *audio{ nullptr };
+    pid_t pid{ -1 };
+};
+
+bool
+ffmpeg_video_audio_pipes(int w, int h, unsigned int fps,
+                         unsigned int sampleRate, unsigned int channels,
+                         const char *outPath, FFmpegPipes &pipes,
+                         bool flip = false) noexcept;
+
+// Closes whatever pipe is still open and waits for the encoder to exit.
+// True when it exited successfully.
+bool
+ffmpeg_wait(FFmpegPipes &pipes) noexcept;
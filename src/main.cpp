@@ -13,13 +13,10 @@ init_args(argparse::ArgumentParser &args)
 
     args.add_argument("--channels", "-c")
         .scan<'i', int>()
-        .default_value(2)
-        .help("No. of channels to be used");
+        .help("No. of channels to be used, 1 to 8 (default: 1)");
 
-    // args.add_argument("-c").scan<'i', int>().help("No. of channels to be
-    // used");
-
-    args.add_argument("--output").help("Output (audio + video) file name");
+    args.add_argument("--output").help(
+        "Output (audio + video) file name, - writes the WAV to stdout");
 
     args.add_argument("--traversal", "-t")
         .scan<'i', int>()
@@ -79,6 +76,72 @@ init_args(argparse::ArgumentParser &args)
         .default_value<std::vector<int>>({ -1, -1 })
         .help("Resize input image to the specified dimension");
 
+    args.add_argument("--angles")
+        .scan<'i', int>()
+        .default_value(360)
+        .help("Number of rays of the clockwise/anticlockwise traversals");
+
+    args.add_argument("--stream").flag().help(
+        "Start playback right away and render the audio while it plays");
+
+    args.add_argument("--memoize").flag().help(
+        "Reuse the audio of identical columns instead of mapping them again");
+
+    args.add_argument("--skip-silent").flag().help(
+        "Make black or fully transparent columns silent without mapping them");
+
+    args.add_argument("--batch").help(
+        "Sonify every image of a directory, glob pattern or list file");
+
+    args.add_argument("--batch-output")
+        .help("Output pattern of batch mode, {dir}, {name} and {index} are "
+              "replaced (default: {dir}/{name}.wav)");
+
+    args.add_argument("--jobs")
+        .scan<'i', unsigned int>()
+        .help("Images sonified at the same time in batch mode (0 = one per "
+              "core)");
+
+    args.add_argument("--band-rows")
+        .scan<'i', int>()
+        .help("Headless only: sonify PNM/PAM images from disk this many rows "
+              "at a time (0 = load the whole image)");
+
+    args.add_argument("--timeline-dir")
+        .help("Keep the rendered audio in a memory mapped file in this "
+              "directory instead of RAM");
+
+    args.add_argument("--sample-format")
+        .help("Sample format of WAV output: s16, s24 or f32 (default: s16)");
+
+    args.add_argument("--buffer-frames")
+        .scan<'i', unsigned int>()
+        .help("Frames per buffer of the audio stream, smaller reacts faster "
+              "(default: 4096)");
+
+    args.add_argument("--low-latency").flag().help(
+        "Start from the smallest audio buffer and grow it only when playback "
+        "underruns");
+
+    args.add_argument("--audio-format")
+        .help("Sample format of the audio stream: s16 or f32 (default: s16)");
+
+    args.add_argument("--spectrogram").flag().help(
+        "Read the image as a spectrogram: columns are frames, rows are "
+        "frequencies from --fmax at the top to --fmin at the bottom");
+
+    args.add_argument("--spectrogram-scale")
+        .help("Frequency axis of --spectrogram: linear or log (default: log)");
+
+    args.add_argument("--griffin-lim")
+        .scan<'i', int>()
+        .help("Griffin-Lim iterations refining the phases of --spectrogram "
+              "(default: 0)");
+
+    args.add_argument("--threads")
+        .scan<'i', unsigned int>()
+        .help("Worker threads used for sonification (0 = all cores)");
+
     args.add_argument("--input", "-i").help("Input file");
 }
 
@@ -1,6 +1,8 @@
 #include "sonify/utils.hpp"
 
+#include "sonify/OscillatorBank.hpp"
 #include "sonify/Pixel.hpp"
+#include "sonify/Wavetable.hpp"
 
 #include <algorithm>
 #include <complex>
@@ -102,6 +104,11 @@ namespace utils
 
     // Applies fade in out to wave
     void applyFadeInOut(std::vector<short> &wave, double fadeFrac) noexcept
+    {
+        applyFadeInOut(std::span<short>(wave), fadeFrac);
+    }
+
+    void applyFadeInOut(std::span<short> wave, double fadeFrac) noexcept
     {
         const size_t N  = wave.size();
         size_t fade_len = static_cast<size_t>(N * fadeFrac); // 10% fade
@@ -129,22 +136,52 @@ namespace utils
     std::vector<short> panStereo(const std::vector<short> &mono,
                                  float pan) noexcept
     {
-        std::vector<short> stereo;
-        stereo.reserve(mono.size() * 2);
-
-        float leftGain  = std::cos(pan * M_PI_2); // smooth panning law
-        float rightGain = std::sin(pan * M_PI_2);
+        std::vector<short> stereo(mono.size() * 2);
+        std::copy(mono.begin(), mono.end(), stereo.begin());
+        panInPlace(stereo, Panning{ 2 }, pan);
+        return stereo;
+    }
 
-        for (auto v : mono)
+    void panInPlace(std::span<short> buffer, const Panning &pan,
+                    float position) noexcept
+    {
+        const unsigned int C = std::max(1u, pan.channels);
+        if (C == 1) return;
+
+        const size_t frames    = buffer.size() / C;
+        const Panning::Gains g = pan.gains(position);
+        short *data            = buffer.data();
+
+        // Back to front, a block at a time: frame i lands at i * C >= i, so
+        // the mono samples still to be read are never overwritten, and the
+        // copy of the block lets the compiler vectorize the writes
+        constexpr size_t BLOCK = 256;
+        float mono[BLOCK];
+        for (size_t end = frames; end > 0;)
         {
-            stereo.push_back(static_cast<short>(v * leftGain));
-            stereo.push_back(static_cast<short>(v * rightGain));
+            const size_t begin = end > BLOCK ? end - BLOCK : 0;
+            const size_t n     = end - begin;
+            for (size_t i = 0; i < n; ++i)
+                mono[i] = data[begin + i];
+
+            short *out = data + begin * C;
+            std::fill(out, out + n * C, 0);
+            for (size_t i = 0; i < n; ++i)
+            {
+                out[i * C + g.first] = static_cast<short>(mono[i] * g.g0);
+                out[i * C + g.second] += static_cast<short>(mono[i] * g.g1);
+            }
+            end = begin;
         }
-        return stereo;
     }
 
     // Normalizes the wave
     void normalizeWave(std::vector<short> &wave) noexcept
+    {
+        normalizeWave(std::span<short>(wave));
+    }
+
+    void normalizeWave(std::span<short> wave) noexcept
     {
         short max_val = 1;
         for (short v : wave)
@@ -198,28 +235,25 @@ namespace utils
     {
         size_t N = static_cast<size_t>(time * samplerate);
         std::vector<short> buffer(N);
+        generateWave(type, amplitude, frequency, samplerate, buffer);
+        return buffer;
+    }
 
-        for (size_t n = 0; n < N; ++n)
+    void generateWave(WaveType type, double amplitude, double frequency,
+                      int samplerate, std::span<short> out) noexcept
+    {
+        if (type == WaveType::SINE)
         {
-            double t     = static_cast<double>(n) / samplerate;
-            double value = 0.0;
-
-            switch (type)
-            {
-                case WaveType::SINE: value = sineAt(t, frequency); break;
-                case WaveType::SQUARE: value = squareAt(t, frequency); break;
-                case WaveType::SAWTOOTH:
-                    value = sawtoothAt(t, frequency);
-                    break;
-                case WaveType::TRIANGLE:
-                    value = triangleAt(t, frequency);
-                    break;
-            }
-
-            buffer[n] = static_cast<short>(amplitude * value * 32767);
+            OscillatorBank osc(static_cast<float>(samplerate));
+            osc.set(0, frequency, static_cast<float>(amplitude), false);
+            osc.render(out);
+            return;
         }
 
-        return buffer;
+        // band-limited, the naive shapes alias above a few kHz
+        WavetableOscillator osc(type, static_cast<float>(samplerate));
+        osc.set(frequency, static_cast<float>(amplitude));
+        osc.render(out);
     }
 
 } // namespace utils